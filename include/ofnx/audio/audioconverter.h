@@ -0,0 +1,107 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef OFNX_AUDIO_AUDIOCONVERTER_H
+#define OFNX_AUDIO_AUDIOCONVERTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "ofnx/ofnx_globals.h"
+
+namespace ofnx::audio {
+
+/**
+ * @brief Streaming sample format, channel count and sample rate conversion
+ *
+ * Samples are interleaved, 16 bits and float samples use the native layout (little endian for files).
+ * Resampling goes through a polyphase windowed sinc filter, buffers are allocated by init only.
+ * Fxm sound is SF_INT16 (SF_UINT8 for 8 bits PCM tracks) at the track rate and channel count.
+ */
+class OFNX_EXPORT AudioConverter final {
+public:
+    enum SampleFormat {
+        SF_UINT8 = 0,
+        SF_INT16 = 1,
+        SF_FLOAT = 2, // [-1, 1], not clamped on output
+    };
+
+    struct Format {
+        SampleFormat sampleFormat = SF_INT16;
+        int channels = 2; // 1 or 2
+        int sampleRate = 44100;
+    };
+
+public:
+    AudioConverter();
+    ~AudioConverter();
+
+    AudioConverter(const AudioConverter& other) = delete;
+    AudioConverter& operator=(const AudioConverter& other) = delete;
+
+    /**
+     * @brief Sets formats, builds the resampling filters and resets the stream
+     *
+     * @param input Input format
+     * @param output Output format
+     * @param blockFrames Input frames processed at once, convert accepts any size
+     */
+    bool init(const Format& input, const Format& output, int blockFrames = 1024);
+
+    /**
+     * @brief Drops buffered samples, the next convert call starts a new stream
+     */
+    void reset();
+
+    const Format& getInputFormat() const;
+    const Format& getOutputFormat() const;
+
+    /**
+     * @brief Upper bound of the frames produced by converting (or flushing) inputFrames frames
+     */
+    size_t maxOutputFrames(size_t inputFrames) const;
+
+    /**
+     * @brief Converts interleaved input frames, part of them may be kept for the next call when resampling
+     *
+     * @param input Whole input frames
+     * @param output Room for maxOutputFrames frames
+     * @param outputSize Bytes written to output
+     */
+    bool convert(std::span<const uint8_t> input, std::span<uint8_t> output, size_t& outputSize);
+
+    /**
+     * @brief Outputs samples still held by the resampler at the end of a stream, then resets it
+     */
+    bool flush(std::span<uint8_t> output, size_t& outputSize);
+
+private:
+    class Impl;
+    Impl* d_ptr;
+};
+
+} // namespace ofnx::audio
+
+#endif // OFNX_AUDIO_AUDIOCONVERTER_H
@@ -0,0 +1,84 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef OFNX_AUDIO_IMAADPCM_H
+#define OFNX_AUDIO_IMAADPCM_H
+
+#include <cstdint>
+#include <span>
+
+#include "ofnx/ofnx_globals.h"
+
+namespace ofnx::audio {
+
+/**
+ * @brief Decodes 4X IMA ADPCM (2 samples per byte, bottom nibble first) to 16 bits little endian PCM
+ */
+class OFNX_EXPORT ImaAdpcm final {
+public:
+    struct State {
+        int predictor = 0; // Last sample
+        int index = 0; // Step index (clamped to [0, 88])
+    };
+
+    /**
+     * @brief Independent mono stream, see decodeStreams
+     */
+    struct Stream {
+        std::span<const uint8_t> input;
+        std::span<uint8_t> output; // 4 bytes per input byte
+        State state; // Updated past the decoded data
+    };
+
+public:
+    ImaAdpcm() = delete;
+
+    /**
+     * @brief Decodes a mono stream
+     *
+     * @param input ADPCM data
+     * @param output PCM data, 4 bytes per input byte
+     * @param state Initial state, updated past the decoded data
+     */
+    static bool decodeMono(std::span<const uint8_t> input, std::span<uint8_t> output, State& state);
+
+    /**
+     * @brief Decodes planar stereo data (same size for both channels) to interleaved PCM in one pass
+     *
+     * @param output PCM data, 8 bytes per left input byte
+     */
+    static bool decodeStereo(
+        std::span<const uint8_t> left, std::span<const uint8_t> right,
+        std::span<uint8_t> output,
+        State& leftState, State& rightState);
+
+    /**
+     * @brief Decodes several independent streams, up to 8 at a time with SSE2
+     */
+    static bool decodeStreams(std::span<Stream> streams);
+};
+
+} // namespace ofnx::audio
+
+#endif // OFNX_AUDIO_IMAADPCM_H
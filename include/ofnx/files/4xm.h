@@ -28,6 +28,8 @@ SOFTWARE.
 #include "ofnx/ofnx_globals.h"
 
 #include <cstdint>
+#include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -40,10 +42,60 @@ public:
         AT_4X_IMA_ADPCM = 1,
     };
 
+    enum ChunkFlag {
+        CF_IFRM = 0x1,
+        CF_PFRM = 0x2,
+        CF_CFRM = 0x4,
+        CF_SOUND = 0x8,
+    };
+
+    /**
+     * @brief Frame index entry, built in the background once the file is opened
+     */
+    struct FrameInfo {
+        uint64_t offset = 0; // FRAM list position in the file
+        uint32_t chunks = 0; // ChunkFlag mask
+        int keyframe = 0; // Nearest frame at or before this one holding an intra frame
+    };
+
+    /**
+     * @brief Chunk read by readPacket, data points into the file and stays valid until close
+     */
+    struct Chunk {
+        uint32_t type = 0; // ChunkFlag, reassembled cfrm frames are CF_PFRM (0 if unused)
+        uint32_t header = 0; // First word of the chunk (0 for reassembled frames)
+        std::span<const uint8_t> data; // Chunk data following the first word
+        std::vector<uint8_t> buffer; // Backs data for reassembled frames, keeps its capacity when the chunk is reused
+    };
+
+    /**
+     * @brief Chunks of one FRAM list
+     */
+    struct Packet {
+        int frame = 0;
+        int videoCount = 0; // Used entries of video, entries past it keep their buffers
+        std::vector<Chunk> video;
+        Chunk sound;
+    };
+
+    /**
+     * @brief Caller owned destination of readFrame
+     */
+    struct FrameOutput {
+        std::span<uint16_t> video; // RGB565 rows, left untouched if no new frame (empty to skip)
+        int videoPitch = 0; // Distance between rows in pixels (0 for the frame width)
+        std::span<uint8_t> audio; // 16 bits PCM, must hold a whole frame of sound (empty to skip)
+
+        // Set by readFrame
+        bool hasVideo = false;
+        size_t audioSize = 0; // Bytes written to audio
+    };
+
     struct TrackVideo {
         std::string name;
         uint32_t width;
         uint32_t height;
+        int version;
     };
 
     struct TrackSound {
@@ -59,7 +111,15 @@ public:
     Fxm();
     ~Fxm();
 
+    /**
+     * @brief Maps the file, chunks are then read in place without copy
+     */
     bool open(const std::string& videoName);
+
+    /**
+     * @brief Same as above for a file already in memory (e.g. from Pak::fileDataShared)
+     */
+    bool open(std::shared_ptr<const std::vector<uint8_t>> data);
     void close();
 
     bool isOpen() const;
@@ -70,6 +130,10 @@ public:
     int getHeight() const;
 
     int getFrameRate() const;
+
+    /**
+     * @brief Waits for frame indexing to finish, playback does not need it
+     */
     int getFrameCount() const;
 
     bool hasSound() const;
@@ -77,6 +141,49 @@ public:
 
     bool readFrame(std::vector<uint16_t>& dataVideo, std::vector<uint8_t>& dataAudio);
 
+    /**
+     * @brief Same as above but writes to caller buffers, no allocation happens once internal buffers fit the largest chunks
+     */
+    bool readFrame(FrameOutput& output);
+
+    /**
+     * @brief Split version of readFrame: demuxes the next frame without decoding it
+     *
+     * readPacket, decodeVideo and decodeSound use separate state and may run on different threads,
+     * as long as each of them is only called from one thread and packets are decoded in order.
+     */
+    bool readPacket(Packet& packet);
+
+    /**
+     * @brief Decodes the video of a packet, returns false if it has none
+     */
+    bool decodeVideo(const Packet& packet, std::vector<uint16_t>& dataVideo);
+
+    /**
+     * @brief Decodes the sound of a packet to 16 bits PCM, returns false if it has none
+     */
+    bool decodeSound(const Packet& packet, std::vector<uint8_t>& dataAudio) const;
+
+    /**
+     * @brief Moves playback so that the next readFrame returns the given frame
+     *
+     * Decoding restarts from the nearest preceding keyframe, skipped frames are decoded without output.
+     * Waits for the frame to be indexed.
+     *
+     * @param frame Frame number
+     */
+    bool seekToFrame(int frame);
+
+    /**
+     * @brief Same as seekToFrame with the frame shown at the given time
+     *
+     * @param seconds Time from the start of the video
+     */
+    bool seekToTime(double seconds);
+
+    int getCurrentFrame() const;
+    FrameInfo getFrameInfo(int frame) const;
+
 private:
     class Impl;
     Impl* d_ptr;
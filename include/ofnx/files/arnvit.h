@@ -28,13 +28,27 @@ SOFTWARE.
 #include "ofnx/ofnx_globals.h"
 
 #include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace ofnx::files {
 
 class OFNX_EXPORT ArnVit final {
 public:
+    enum class AccessMode {
+        READ, // Sprite data is read from file on each request
+        MAP, // ARN file is memory-mapped once, views can be requested
+    };
+
+    enum class ImageFormat {
+        BMP_RGB555,
+        BMP_RGB24,
+        BMP_ARGB32,
+        PNG_RGB24,
+    };
+
     struct ArnVitFile {
         std::string fileName;
         uint32_t width;
@@ -50,6 +64,18 @@ public:
         std::vector<uint8_t> data;
     };
 
+    /**
+     * @brief Lightweight sprite descriptor pointing into the mapped ARN file
+     *
+     * Only valid while the ArnVit stays open.
+     */
+    struct ArnVitView {
+        std::string_view fileName;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::span<const uint8_t> data; // RGB565 pixels
+    };
+
 public:
     ArnVit();
     ~ArnVit();
@@ -57,15 +83,42 @@ public:
     ArnVit(const ArnVit& other) = delete;
     ArnVit& operator=(const ArnVit& other) = delete;
 
-    bool open(const std::string& vitFileName, const std::string& arnFileName);
+    bool open(const std::string& vitFileName, const std::string& arnFileName, AccessMode mode = AccessMode::READ);
     void close();
     bool isOpen() const;
 
     int fileCount() const;
+    int indexOf(std::string_view name) const;
     ArnVitFile getFile(const int index) const;
     ArnVitFile getFile(const std::string& name) const;
+
+    /**
+     * @brief Returns a view over sprite pixels without copying them
+     *
+     * Requires AccessMode::MAP, an empty view is returned otherwise.
+     */
+    ArnVitView getView(const int index) const;
+    ArnVitView getView(std::string_view name) const;
     bool writeToBmp(const int index, const std::string& outputDirectory) const;
 
+    /**
+     * @brief Converts a sprite and writes it to outputDirectory in a single write
+     *
+     * @param index Sprite index
+     * @param outputDirectory Output directory (including trailing separator)
+     * @param format Output image format (PNG files get a .png extension)
+     */
+    bool writeImage(const int index, const std::string& outputDirectory, ImageFormat format) const;
+
+    /**
+     * @brief Exports every sprite, spreading work across threads
+     *
+     * @param outputDirectory Output directory (including trailing separator)
+     * @param format Output image format
+     * @param threadCount Worker count (0 uses hardware concurrency)
+     */
+    bool exportAll(const std::string& outputDirectory, ImageFormat format, int threadCount = 0) const;
+
 private:
     class Impl;
     Impl* d_ptr;
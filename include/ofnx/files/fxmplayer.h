@@ -0,0 +1,120 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef OFNX_FILES_FXMPLAYER_H
+#define OFNX_FILES_FXMPLAYER_H
+
+#include "ofnx/ofnx_globals.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ofnx/files/4xm.h"
+
+namespace ofnx::files {
+
+/**
+ * @brief Plays 4X Movies with demux, video decode and sound decode on their own threads
+ *
+ * Stages are connected by lock-free single producer / single consumer rings of pooled buffers.
+ * Decoded frames and sound blocks wait in output rings until the caller picks them up,
+ * consumer calls never block.
+ * Frames are demuxed in order, so while sound is enabled, sound blocks must be drained as well:
+ * once the sound rings are full, video stops too. Disable sound for muted playback.
+ */
+class OFNX_EXPORT FxmPlayer final {
+public:
+    struct VideoFrame {
+        int frame = 0;
+        std::vector<uint16_t> pixels; // RGB565, width * height
+    };
+
+    struct SoundBlock {
+        int frame = 0;
+        std::vector<uint8_t> samples; // 16 bits PCM
+    };
+
+public:
+    /**
+     * @param lookahead Frames demuxed and decoded ahead of the consumer, per stage
+     */
+    FxmPlayer(int lookahead = 8);
+    ~FxmPlayer();
+
+    FxmPlayer(const FxmPlayer& other) = delete;
+    FxmPlayer& operator=(const FxmPlayer& other) = delete;
+
+    /**
+     * @brief Opens a video and starts decoding ahead
+     */
+    bool open(const std::string& videoName);
+    void close();
+
+    /**
+     * @brief Enables the sound stage (default), applies to the next open call
+     *
+     * Sound chunks are dropped by the demuxer when disabled.
+     */
+    void setSoundEnabled(bool enabled);
+    bool isSoundEnabled() const;
+
+    bool isOpen() const;
+
+    int getWidth() const;
+    int getHeight() const;
+    int getFrameRate() const;
+
+    bool hasSound() const;
+    const Fxm::TrackSound& getTrackSound() const;
+
+    /**
+     * @brief Returns the oldest decoded frame, or null if none is ready
+     *
+     * The frame stays valid until popVideoFrame.
+     */
+    const VideoFrame* peekVideoFrame() const;
+    void popVideoFrame();
+
+    /**
+     * @brief Returns the oldest decoded sound block, or null if none is ready
+     *
+     * The block stays valid until popSoundBlock.
+     */
+    const SoundBlock* peekSoundBlock() const;
+    void popSoundBlock();
+
+    /**
+     * @brief True once every frame has been decoded and picked up
+     */
+    bool isFinished() const;
+
+private:
+    class Impl;
+    Impl* d_ptr;
+};
+
+} // namespace ofnx::files
+
+#endif // OFNX_FILES_FXMPLAYER_H
@@ -27,8 +27,11 @@ SOFTWARE.
 
 #include "ofnx/ofnx_globals.h"
 
+#include <cstdint>
+#include <map>
 #include <set>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -48,12 +51,65 @@ public:
     ~Lst();
 
     bool parseLst(const std::string& fileName);
+
+    /**
+     * @brief Re-parses only the [warp] sections and subroutines whose content changed since the last parse
+     *
+     * Warp ids and unchanged instruction blocks are kept, removed warps keep their id with empty blocks.
+     * Falls back to a full parse when current data does not come from a single parseLst call.
+     * Current data is left untouched if the new script has errors.
+     *
+     * @param fileName LST file name
+     */
+    bool reloadLst(const std::string& fileName);
     bool saveLst(const std::string& fileName);
 
+    /**
+     * @brief Writes parsed data to a binary cache file
+     *
+     * @param fileName Cache file name
+     * @param sourceSize Size of the LST file the data comes from (checked by loadLst)
+     */
+    bool saveCache(const std::string& fileName, uint64_t sourceSize = 0) const;
+
+    /**
+     * @brief Replaces current data with a binary cache file content
+     *
+     * @param fileName Cache file name
+     */
+    bool loadCache(const std::string& fileName);
+
+    /**
+     * @brief Loads the cache if it is up to date, otherwise parses the LST file and rewrites the cache
+     *
+     * @param fileName LST file name
+     * @param cacheFileName Cache file name
+     */
+    bool loadLst(const std::string& fileName, const std::string& cacheFileName);
+
     const std::set<std::string>& getVariables() const;
     const InstructionBlock& getInitBlock(const std::string& warpName) const;
     const InstructionBlock& getTestBlock(const std::string& warpName, const int& testId) const;
 
+    /**
+     * @brief Warps are numbered in order of appearance, ids are stable for a given script
+     */
+    int getWarpCount() const;
+    int getWarpId(std::string_view warpName) const;
+    const std::string& getWarpName(int warpId) const;
+
+    /**
+     * @brief Id based lookups, an empty block is returned for unknown warps or tests
+     */
+    const InstructionBlock& getInitBlock(int warpId) const;
+    const InstructionBlock& getTestBlock(int warpId, int testId) const;
+    bool hasTestBlock(int warpId, int testId) const;
+
+    const std::string& getInitWarp() const;
+    std::vector<std::string> getWarps() const; // In warp id order
+    std::vector<int> getTestIds(const std::string& warpName) const;
+    const std::map<std::string, Instruction>& getSubroutines() const;
+
 private:
     class Impl;
     Impl* d_ptr;
@@ -0,0 +1,100 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef OFNX_FILES_LSTGRAPH_H
+#define OFNX_FILES_LSTGRAPH_H
+
+#include "ofnx/ofnx_globals.h"
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ofnx::files {
+
+class Lst;
+
+/**
+ * @brief Warp transition graph extracted from a parsed LST
+ *
+ * Every gotowarp is turned into an edge, following gosub calls.
+ * Warp ids match Lst ones, targets missing from the script are appended after them.
+ */
+class OFNX_EXPORT LstGraph final {
+public:
+    struct Guard {
+        bool isOr; // ifor (any variable set) or ifand (all variables set)
+        std::vector<std::string> variables;
+    };
+
+    struct Edge {
+        int from;
+        int to;
+        int testId; // Hotspot test leading to the warp, -1 for the init block (no click needed)
+        std::vector<Guard> guards; // Conditions enclosing the gotowarp, all must hold
+    };
+
+    struct Reach {
+        int warpId;
+        int clicks;
+    };
+
+public:
+    LstGraph();
+    ~LstGraph();
+
+    LstGraph(const LstGraph& other) = delete;
+    LstGraph& operator=(const LstGraph& other) = delete;
+
+    bool build(const Lst& lst);
+    void clear();
+
+    int warpCount() const;
+    int warpId(std::string_view name) const;
+    const std::string& warpName(int warpId) const;
+
+    /**
+     * @brief Returns outgoing edges of a warp
+     */
+    std::span<const Edge> edges(int warpId) const;
+
+    /**
+     * @brief Returns warps reachable from a warp, ignoring guards, sorted by click count
+     *
+     * Init block transitions cost no click, hotspot tests cost one.
+     *
+     * @param warpId Starting warp (not included in the result)
+     * @param maxClicks Maximum click count
+     */
+    std::vector<Reach> reachable(int warpId, int maxClicks) const;
+
+private:
+    class Impl;
+    Impl* d_ptr;
+};
+
+} // namespace ofnx::files
+
+#endif // OFNX_FILES_LSTGRAPH_H
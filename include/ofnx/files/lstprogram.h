@@ -0,0 +1,137 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef OFNX_FILES_LSTPROGRAM_H
+#define OFNX_FILES_LSTPROGRAM_H
+
+#include "ofnx/ofnx_globals.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace ofnx::files {
+
+class Lst;
+
+/**
+ * @brief LST script compiled to flat bytecode
+ *
+ * Instruction names are resolved to opcodes, variables and warps to dense ids
+ * and parameters are parsed once. Blocks are terminated by END, subroutines by RETURN.
+ */
+class OFNX_EXPORT LstProgram final {
+public:
+    enum class Opcode : uint8_t {
+        // Executed by LstVm
+        END,
+        RETURN,
+        SET, // operands: variable, value
+        IF_AND, // operands: variables, jumps to target unless all are set
+        IF_OR, // operands: variables, jumps to target unless one is set
+        GOSUB, // target: subroutine entry (-1 if unknown)
+
+        // Forwarded to LstVm handlers
+        GOTOWARP, // target: warp id
+        PLAYMUSIQUE,
+        STOPMUSIQUE,
+        PLAYSOUND,
+        STOPSOUND,
+        PLAYSOUND3D,
+        STOPSOUND3D,
+        SETCURSOR,
+        SETCURSORDEFAULT,
+        HIDECURSOR,
+        SETANGLE,
+        INTERPOLANGLE,
+        ANGLEXMAX,
+        ANGLEYMAX,
+        FADE,
+        LOCKKEY,
+        RESETLOCKKEY,
+        SETZOOM,
+        NOT,
+        PLUGIN_CALL, // target: function name string id
+
+        COUNT,
+    };
+
+    struct Operand {
+        int32_t integer = 0; // Parsed integer (0 if not a number), variable id for SET/IF_AND/IF_OR
+        float number = 0.0f; // Parsed float (0 if not a number)
+        uint32_t string = 0; // Raw parameter string id
+    };
+
+    struct Op {
+        Opcode opcode;
+        uint16_t operandCount = 0;
+        uint32_t operandOffset = 0;
+        int32_t target = -1; // Jump target, subroutine entry, warp id or string id (see Opcode)
+    };
+
+public:
+    LstProgram();
+    ~LstProgram();
+
+    LstProgram(const LstProgram& other) = delete;
+    LstProgram& operator=(const LstProgram& other) = delete;
+
+    /**
+     * @brief Compiles every warp block and subroutine of a parsed LST
+     *
+     * @param lst Parsed LST
+     */
+    bool compile(const Lst& lst);
+    void clear();
+
+    std::span<const Op> code() const;
+    std::span<const Operand> operands(const Op& op) const;
+
+    int variableCount() const;
+    int variableId(std::string_view name) const;
+    const std::string& variableName(int id) const;
+
+    int warpCount() const;
+    int warpId(std::string_view name) const;
+    const std::string& warpName(int id) const;
+    int initWarp() const;
+
+    const std::string& string(uint32_t id) const;
+
+    /**
+     * @brief Returns block entry offset in code() (-1 if missing)
+     */
+    int initBlock(int warpId) const;
+    int testBlock(int warpId, int testId) const;
+    int subroutine(std::string_view name) const;
+
+private:
+    class Impl;
+    Impl* d_ptr;
+};
+
+} // namespace ofnx::files
+
+#endif // OFNX_FILES_LSTPROGRAM_H
@@ -0,0 +1,94 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef OFNX_FILES_LSTVM_H
+#define OFNX_FILES_LSTVM_H
+
+#include "ofnx/ofnx_globals.h"
+
+#include <cstdint>
+#include <functional>
+#include <span>
+
+#include "ofnx/files/lstprogram.h"
+
+namespace ofnx::files {
+
+/**
+ * @brief Executes compiled LST bytecode
+ *
+ * Control flow and variables are handled internally, every other opcode
+ * is forwarded to the handler registered for it (ignored if none).
+ */
+class OFNX_EXPORT LstVm final {
+public:
+    using Handler = std::function<void(const LstProgram::Op& op, std::span<const LstProgram::Operand> operands)>;
+
+public:
+    LstVm();
+    ~LstVm();
+
+    LstVm(const LstVm& other) = delete;
+    LstVm& operator=(const LstVm& other) = delete;
+
+    /**
+     * @brief Sets the program to run and clears every variable
+     *
+     * @param program Compiled program (must outlive the VM or be replaced)
+     */
+    void setProgram(const LstProgram* program);
+    void setHandler(LstProgram::Opcode opcode, Handler handler);
+
+    bool variable(int id) const;
+    void setVariable(int id, bool value);
+    std::span<const uint8_t> variables() const;
+
+    bool runInitBlock(int warpId);
+    bool runTestBlock(int warpId, int testId);
+
+    /**
+     * @brief Runs code from entry until END (or RETURN outside of a subroutine)
+     *
+     * Handlers may run other blocks, nested runs are bounded so the call stack never grows.
+     *
+     * @param entry Entry offset in program code
+     */
+    bool run(int entry);
+
+    /**
+     * @brief Stops the innermost running block once the current handler returns
+     *
+     * Blocks the handler runs afterwards still execute. A stop raised in a nested run
+     * also stops the blocks that started it.
+     */
+    void stop();
+
+private:
+    class Impl;
+    Impl* d_ptr;
+};
+
+} // namespace ofnx::files
+
+#endif // OFNX_FILES_LSTVM_H
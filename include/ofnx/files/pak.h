@@ -28,12 +28,26 @@ SOFTWARE.
 #include "ofnx/ofnx_globals.h"
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace ofnx::files {
 
 class OFNX_EXPORT Pak final {
+public:
+    /**
+     * @brief Match search effort used when compressing new entries
+     *
+     * Higher levels follow longer hash chains and enable lazy matching,
+     * trading compression speed for smaller output.
+     */
+    enum class CompressionEffort {
+        FAST,
+        NORMAL,
+        BEST,
+    };
+
 public:
     Pak();
     ~Pak();
@@ -49,6 +63,32 @@ public:
     std::string fileName(int index) const;
     std::vector<uint8_t> fileData(int index) const;
 
+    /**
+     * @brief Returns shared decompressed entry data (nullptr on error)
+     *
+     * Goes through PakCache when it is enabled so repeated lookups of the same
+     * entry, from any Pak instance, skip decompression.
+     *
+     * @param index Entry index
+     */
+    std::shared_ptr<const std::vector<uint8_t>> fileDataShared(int index) const;
+
+    /**
+     * @brief Adds (or replaces) an entry, compressing it with level 3
+     *
+     * @param fileName Entry name (15 characters max)
+     * @param data Uncompressed entry data
+     * @param effort Match search effort
+     */
+    bool addFile(const std::string& fileName, const std::vector<uint8_t>& data, CompressionEffort effort = CompressionEffort::NORMAL);
+
+    /**
+     * @brief Writes header, entry table and compressed data to a PAK archive
+     *
+     * @param pakFileName Output file name
+     */
+    bool save(const std::string& pakFileName);
+
 private:
     class Impl;
     Impl* d_ptr;
@@ -0,0 +1,96 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef OFNX_FILES_PAKCACHE_H
+#define OFNX_FILES_PAKCACHE_H
+
+#include "ofnx/ofnx_globals.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ofnx::files {
+
+/**
+ * @brief Process-wide LRU cache of decompressed PAK entries
+ *
+ * Shared by every Pak instance, entries are keyed by archive path and entry index.
+ * The cache is disabled until a byte budget is set.
+ */
+class OFNX_EXPORT PakCache final {
+    friend class Pak;
+
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t bytes = 0;
+        size_t entries = 0;
+    };
+
+public:
+    PakCache(const PakCache& other) = delete;
+    PakCache& operator=(const PakCache& other) = delete;
+
+    static PakCache& instance();
+
+    /**
+     * @brief Sets the maximum amount of decompressed bytes kept in cache
+     *
+     * Least recently used entries are evicted to fit the new budget.
+     *
+     * @param bytes Byte budget (0 disables the cache)
+     */
+    void setBudget(size_t bytes);
+    size_t budget() const;
+
+    Stats stats() const;
+    void resetStats();
+
+    /**
+     * @brief Drops every cached entry
+     */
+    void clear();
+
+private:
+    PakCache();
+    ~PakCache();
+
+    uint32_t registerArchive(const std::string& pakFileName, uint64_t stamp);
+    void removeArchive(uint32_t archive);
+
+    std::shared_ptr<const std::vector<uint8_t>> find(uint32_t archive, uint32_t index);
+    void insert(uint32_t archive, uint32_t index, const std::shared_ptr<const std::vector<uint8_t>>& data);
+    void remove(uint32_t archive, uint32_t index);
+
+    class Impl;
+    Impl* d_ptr;
+};
+
+} // namespace ofnx::files
+
+#endif // OFNX_FILES_PAKCACHE_H
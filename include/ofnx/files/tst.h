@@ -27,6 +27,8 @@ SOFTWARE.
 
 #include "ofnx/ofnx_globals.h"
 
+#include <cstdint>
+#include <span>
 #include <string>
 
 namespace ofnx::files {
@@ -37,6 +39,20 @@ namespace ofnx::files {
  * Provides methods to check wich zone (if any) is clicked.
  */
 class OFNX_EXPORT Tst final {
+public:
+    static constexpr int16_t ZONE_MAP_NONE = -1; // No zone in cell
+    static constexpr int16_t ZONE_MAP_BORDER = -2; // Cell crossed by a zone border
+
+    /**
+     * @brief Rasterised zone ids, row-major (width * height cells)
+     */
+    struct ZoneMap {
+        int width = 0;
+        int height = 0;
+        float step = 0.0f; // Cell size (pixels for static, degrees for VR)
+        std::span<const int16_t> zones;
+    };
+
 public:
     Tst();
     ~Tst();
@@ -46,8 +62,41 @@ public:
 
     bool loadFile(const std::string& fileName);
 
-    int checkZoneStatic(float x, float y);
-    int checkZoneVr(float yawDeg, float pitchDeg);
+    int zoneCount() const;
+
+    int checkZoneStatic(float x, float y) const;
+    int checkZoneVr(float yawDeg, float pitchDeg) const;
+
+    /**
+     * @brief Batch version of checkZoneStatic
+     *
+     * @param points Interleaved x, y coordinates
+     * @param zones Output zone index for each point (-1 if none)
+     */
+    void checkZoneStatic(std::span<const float> points, std::span<int> zones) const;
+
+    /**
+     * @brief Batch version of checkZoneVr
+     *
+     * @param anglesDeg Interleaved yaw, pitch angles in degrees
+     * @param zones Output zone index for each angle pair (-1 if none)
+     */
+    void checkZoneVr(std::span<const float> anglesDeg, std::span<int> zones) const;
+
+    /**
+     * @brief Enables zone id maps for constant time lookups
+     *
+     * Zones are rasterised into a 640*480 map and a yaw [0, 360[ / pitch [-90, 90] grid.
+     * Cells crossed by a zone border fall back to the linear scan, so results are unchanged.
+     * Maps are rebuilt by loadFile while enabled.
+     *
+     * @param vrStepDeg VR grid resolution in degrees
+     */
+    bool enableZoneMaps(float vrStepDeg = 0.5f);
+    void disableZoneMaps();
+
+    ZoneMap zoneMapStatic() const;
+    ZoneMap zoneMapVr() const;
 
 private:
     class Impl;
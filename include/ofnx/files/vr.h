@@ -83,6 +83,11 @@ public:
      */
     Type getType() const;
 
+    /**
+     * @brief Returns the amount of memory held by loaded data (compressed image and animations)
+     */
+    size_t getDataSize() const;
+
     /**
      * @brief Unpacks image data into dataRgb565 using RGB565 pixel format
      *
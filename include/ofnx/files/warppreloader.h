@@ -0,0 +1,142 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef OFNX_FILES_WARPPRELOADER_H
+#define OFNX_FILES_WARPPRELOADER_H
+
+#include "ofnx/ofnx_globals.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ofnx::files {
+
+class LstGraph;
+class Tst;
+class Vr;
+
+/**
+ * @brief Loads and decodes neighbouring warps on background threads
+ *
+ * Warps reachable from the current one (see LstGraph::reachable) are queued, closest first,
+ * targets of the hovered hotspot test before everything else.
+ * Loaded warps are kept in a bounded LRU cache, changing warp drops pending jobs.
+ */
+class OFNX_EXPORT WarpPreloader final {
+public:
+    struct Warp {
+        std::string name;
+        std::shared_ptr<Vr> vr;
+        std::shared_ptr<Tst> tst; // Null if the warp has no test file
+        std::vector<uint16_t> dataRgb565; // Decoded VR image
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t loads = 0; // Background loads
+        uint64_t evictions = 0;
+        size_t bytes = 0; // Decoded pixels and VR data
+        size_t entries = 0;
+    };
+
+public:
+    /**
+     * @param threadCount Worker thread count (0 uses 2 threads)
+     */
+    WarpPreloader(int threadCount = 0);
+    ~WarpPreloader();
+
+    WarpPreloader(const WarpPreloader& other) = delete;
+    WarpPreloader& operator=(const WarpPreloader& other) = delete;
+
+    /**
+     * @brief Sets the directory warp files are read from
+     */
+    void setDataDirectory(const std::string& directory);
+
+    /**
+     * @brief Sets the transition graph used to find neighbouring warps (not owned, may be null)
+     */
+    void setGraph(const LstGraph* graph);
+
+    /**
+     * @brief Sets the maximum amount of memory kept in cache, decoded pixels and VR data (64 MiB by default)
+     */
+    void setBudget(size_t bytes);
+
+    /**
+     * @brief Sets how many clicks away from the current warp are preloaded (1 by default)
+     */
+    void setMaxClicks(int maxClicks);
+
+    /**
+     * @brief Cancels pending jobs and queues neighbours of a warp
+     *
+     * @param warpId LstGraph warp id (-1 to stop preloading)
+     */
+    void setCurrentWarp(int warpId);
+
+    /**
+     * @brief Moves targets of a hotspot test of the current warp to the front of the queue
+     *
+     * @param testId Hovered test id (-1 if none)
+     */
+    void setHoveredTest(int testId);
+
+    /**
+     * @brief Returns a warp, waiting for its background load or loading it in place if needed
+     *
+     * @param warpName Warp name as found in the LST script
+     * @return Null if the warp could not be loaded
+     */
+    std::shared_ptr<const Warp> get(const std::string& warpName);
+
+    /**
+     * @brief Returns a cached warp without loading it (null if not ready)
+     */
+    std::shared_ptr<const Warp> find(const std::string& warpName);
+
+    /**
+     * @brief Drops pending jobs (loads already running are finished)
+     */
+    void cancel();
+
+    /**
+     * @brief Drops every cached warp
+     */
+    void clear();
+
+    Stats stats() const;
+
+private:
+    class Impl;
+    Impl* d_ptr;
+};
+
+} // namespace ofnx::files
+
+#endif // OFNX_FILES_WARPPRELOADER_H
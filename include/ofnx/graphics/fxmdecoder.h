@@ -0,0 +1,90 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef OFNX_GRAPHICS_FXMDECODER_H
+#define OFNX_GRAPHICS_FXMDECODER_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "ofnx/ofnx_globals.h"
+
+namespace ofnx::graphics {
+
+/**
+ * @brief Decodes 4X Movie video frames to RGB565
+ *
+ * Frame buffers are kept between calls and reused, predicted frames are decoded
+ * into a second buffer which is swapped with the current one.
+ */
+class OFNX_EXPORT FxmDecoder final {
+public:
+    FxmDecoder();
+    ~FxmDecoder();
+
+    FxmDecoder(const FxmDecoder& other) = delete;
+    FxmDecoder& operator=(const FxmDecoder& other) = delete;
+
+    /**
+     * @brief Sets frame format and clears frame buffers
+     *
+     * @param width Width (multiple of 16)
+     * @param height Height (multiple of 16)
+     * @param version Stream version (from the video track header)
+     */
+    bool init(int width, int height, int version);
+
+    int getWidth() const;
+    int getHeight() const;
+    int getVersion() const;
+
+    /**
+     * @brief Decodes an intra frame (ifrm)
+     *
+     * @param data Chunk data following its first word (bitstream size onwards)
+     */
+    bool decodeIntraFrame(std::span<const uint8_t> data);
+
+    /**
+     * @brief Decodes a predicted frame (pfrm) against the last decoded frame
+     *
+     * @param data Chunk data following its first word
+     * @param streamSizes Chunk first word, holds stream sizes for version 1 streams
+     */
+    bool decodePredictedFrame(std::span<const uint8_t> data, uint32_t streamSizes = 0);
+
+    /**
+     * @brief Returns the last decoded frame (width * height RGB565 pixels)
+     */
+    std::span<const uint16_t> getFrame() const;
+
+private:
+    class Impl;
+    Impl* d_ptr;
+};
+
+} // namespace ofnx::graphics
+
+#endif // OFNX_GRAPHICS_FXMDECODER_H
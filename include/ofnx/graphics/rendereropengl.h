@@ -28,9 +28,12 @@ SOFTWARE.
 #include "ofnx/ofnx_globals.h"
 
 #include <string>
+#include <vector>
 
 namespace ofnx::graphics {
 
+class SpriteAtlas;
+
 /**
  * @brief OpenGL rendering class.
  *
@@ -38,6 +41,13 @@ namespace ofnx::graphics {
  * SDL_Init(SDL_INIT_VIDEO) must be called before calling init
  */
 class OFNX_EXPORT RendererOpenGL final {
+public:
+    struct SpriteInstance {
+        int spriteId; // SpriteAtlas sprite id
+        int x; // Top left position, in 640*480 frame coordinates
+        int y;
+    };
+
 public:
     RendererOpenGL();
     ~RendererOpenGL();
@@ -51,6 +61,21 @@ public:
     void renderVr(int width, int height, float yaw, float pitch, float roll, float fov);
     void renderFrame();
 
+    /**
+     * @brief Uploads every atlas page into a texture array
+     *
+     * The atlas must stay alive while sprites are rendered from it.
+     */
+    bool updateSpriteAtlas(const SpriteAtlas& atlas);
+
+    /**
+     * @brief Draws sprites over the current frame in a single instanced draw call
+     *
+     * @param sprites Sprites to draw, back to front
+     * @param colorKey RGB565 color treated as transparent (-1 to disable)
+     */
+    void renderSprites(const std::vector<SpriteInstance>& sprites, int colorKey = -1);
+
 private:
     class Impl;
     Impl* d_ptr;
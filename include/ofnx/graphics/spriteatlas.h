@@ -0,0 +1,108 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef OFNX_GRAPHICS_SPRITEATLAS_H
+#define OFNX_GRAPHICS_SPRITEATLAS_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "ofnx/ofnx_globals.h"
+
+namespace ofnx::files {
+class ArnVit;
+} // namespace ofnx::files
+
+namespace ofnx::graphics {
+
+/**
+ * @brief Packs RGB565 sprites into square atlas pages
+ *
+ * Uses a skyline bottom-left packer, new pages are created when a sprite
+ * does not fit anymore. Pages are meant to be uploaded once as a texture array.
+ */
+class OFNX_EXPORT SpriteAtlas final {
+public:
+    struct Region {
+        int page = -1;
+        uint16_t x = 0;
+        uint16_t y = 0;
+        uint16_t width = 0;
+        uint16_t height = 0;
+    };
+
+public:
+    SpriteAtlas(int pageSize = 1024);
+    ~SpriteAtlas();
+
+    SpriteAtlas(const SpriteAtlas& other) = delete;
+    SpriteAtlas& operator=(const SpriteAtlas& other) = delete;
+
+    /**
+     * @brief Clears the atlas and packs every sprite of an ARN/VIT pair
+     *
+     * Sprites are packed tallest first, sprite ids match ArnVit indices.
+     *
+     * @param arnVit Opened ArnVit
+     */
+    bool build(const ofnx::files::ArnVit& arnVit);
+
+    /**
+     * @brief Packs a single sprite
+     *
+     * @param name Sprite name
+     * @param width Sprite width
+     * @param height Sprite height
+     * @param dataRgb565 Sprite pixels (width * height, RGB565)
+     *
+     * @return Sprite id, -1 on error
+     */
+    int addSprite(const std::string& name, int width, int height, const uint16_t* dataRgb565);
+
+    void clear();
+
+    int pageSize() const;
+    int pageCount() const;
+    int spriteCount() const;
+    int indexOf(std::string_view name) const;
+
+    /**
+     * @brief Returns sprite location (page is -1 if id is invalid)
+     */
+    Region region(int spriteId) const;
+
+    /**
+     * @brief Returns page pixels (pageSize * pageSize, RGB565), nullptr if invalid
+     */
+    const uint16_t* pageData(int page) const;
+
+private:
+    class Impl;
+    Impl* d_ptr;
+};
+
+} // namespace ofnx::graphics
+
+#endif // OFNX_GRAPHICS_SPRITEATLAS_H
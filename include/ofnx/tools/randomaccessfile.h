@@ -0,0 +1,111 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef OFNX_TOOLS_RANDOMACCESSFILE_H
+#define OFNX_TOOLS_RANDOMACCESSFILE_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include "ofnx/ofnx_globals.h"
+
+namespace ofnx::tools {
+
+/**
+ * @brief Read-only file accessed through positional reads
+ *
+ * Unlike std::fstream, reads do not share a file position so they can be
+ * issued concurrently from several threads without locking (pread on POSIX,
+ * overlapped ReadFile on Windows).
+ * The whole file can also be mapped in memory to access it without copies.
+ */
+class OFNX_EXPORT RandomAccessFile final {
+public:
+    enum class Advice {
+        NORMAL,
+        SEQUENTIAL, // Aggressive readahead, pages behind can be dropped
+        RANDOM, // No readahead
+        WILL_NEED, // Start reading the range in the background
+    };
+
+public:
+    RandomAccessFile();
+    ~RandomAccessFile();
+
+    RandomAccessFile(const RandomAccessFile& other) = delete;
+    RandomAccessFile& operator=(const RandomAccessFile& other) = delete;
+
+    bool open(const std::string& fileName);
+    void close();
+    bool isOpen() const;
+
+    /**
+     * @brief Returns file size in bytes (0 if not open)
+     */
+    uint64_t size() const;
+
+    /**
+     * @brief Reads bytes at an absolute offset
+     *
+     * Thread-safe, fails if the requested range is not entirely available.
+     *
+     * @param offset Offset from the start of the file
+     * @param size Number of bytes to read
+     * @param data Output buffer (at least size bytes)
+     */
+    bool read(uint64_t offset, size_t size, uint8_t* data) const;
+
+    /**
+     * @brief Maps the whole file in memory (read-only)
+     *
+     * Once mapped, read() copies from the mapping.
+     */
+    bool map();
+    bool isMapped() const;
+
+    /**
+     * @brief Returns mapped file content (empty if not mapped)
+     */
+    std::span<const uint8_t> mappedData() const;
+
+    /**
+     * @brief Hints the system about upcoming accesses (no-op where unsupported)
+     *
+     * Applies to the mapping if the file is mapped, to positional reads otherwise.
+     *
+     * @param offset Range start
+     * @param size Range size (0 up to the end of the file)
+     * @param advice Expected access pattern
+     */
+    void advise(uint64_t offset, uint64_t size, Advice advice) const;
+
+private:
+    class Impl;
+    Impl* d_ptr;
+};
+
+} // namespace ofnx::tools
+
+#endif // OFNX_TOOLS_RANDOMACCESSFILE_H
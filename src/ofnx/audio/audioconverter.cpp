@@ -0,0 +1,522 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "ofnx/audio/audioconverter.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#include "ofnx/tools/log.h"
+#include "ofnx/tools/simd.h"
+
+namespace ofnx::audio {
+
+#define AUDIO_CONVERTER_MAX_CHANNELS 2
+#define AUDIO_CONVERTER_MAX_RATE 384000
+#define AUDIO_CONVERTER_MAX_BLOCK (1 << 20)
+#define AUDIO_RESAMPLER_TAPS 32 // Filter length, multiple of 4
+#define AUDIO_RESAMPLER_HALF_TAPS (AUDIO_RESAMPLER_TAPS / 2)
+#define AUDIO_RESAMPLER_MAX_PHASES 1024 // Larger interpolation factors use the nearest filter
+#define AUDIO_RESAMPLER_ROLLOFF 0.92 // Passband, fraction of the lowest Nyquist frequency
+
+/* Helper functions */
+size_t sampleBytes(AudioConverter::SampleFormat format)
+{
+    switch (format) {
+    case AudioConverter::SF_UINT8:
+        return 1;
+    case AudioConverter::SF_INT16:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
+bool isValid(const AudioConverter::Format& format)
+{
+    return format.sampleFormat >= AudioConverter::SF_UINT8 && format.sampleFormat <= AudioConverter::SF_FLOAT
+        && format.channels >= 1 && format.channels <= AUDIO_CONVERTER_MAX_CHANNELS
+        && format.sampleRate > 0 && format.sampleRate <= AUDIO_CONVERTER_MAX_RATE;
+}
+
+inline float readSample(const uint8_t* input, AudioConverter::SampleFormat format)
+{
+    switch (format) {
+    case AudioConverter::SF_UINT8:
+        return (int(input[0]) - 128) * (1.0f / 128.0f);
+    case AudioConverter::SF_INT16: {
+        int16_t value;
+        std::memcpy(&value, input, 2);
+        return value * (1.0f / 32768.0f);
+    }
+    default: {
+        float value;
+        std::memcpy(&value, input, 4);
+        return value;
+    }
+    }
+}
+
+inline void writeSample(uint8_t* output, float sample, AudioConverter::SampleFormat format)
+{
+    switch (format) {
+    case AudioConverter::SF_UINT8:
+        output[0] = uint8_t(std::clamp(std::lrint(sample * 128.0f) + 128, 0L, 255L));
+        break;
+    case AudioConverter::SF_INT16: {
+        int16_t value = int16_t(std::clamp(std::lrint(sample * 32768.0f), -32768L, 32767L));
+        std::memcpy(output, &value, 2);
+        break;
+    }
+    default:
+        std::memcpy(output, &sample, 4);
+        break;
+    }
+}
+
+/**
+ * Blackman windowed sinc.
+ * @param x Distance to the filter centre in input samples
+ * @param cutoff Cutoff frequency in cycles per input sample
+ */
+double windowedSinc(double x, double cutoff)
+{
+    double window = 0.42 + 0.5 * std::cos(M_PI * x / AUDIO_RESAMPLER_HALF_TAPS)
+        + 0.08 * std::cos(2.0 * M_PI * x / AUDIO_RESAMPLER_HALF_TAPS);
+    double y = 2.0 * cutoff * x;
+    double sinc = y == 0.0 ? 1.0 : std::sin(M_PI * y) / (M_PI * y);
+
+    return 2.0 * cutoff * sinc * std::max(window, 0.0);
+}
+
+/**
+ * Filters AUDIO_RESAMPLER_TAPS input samples.
+ */
+inline float dotProduct(const float* samples, const float* filter)
+{
+#ifdef OFNX_SIMD_SSE2
+    // Two accumulators to hide the addition latency
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+    for (int i = 0; i < AUDIO_RESAMPLER_TAPS; i += 8) {
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_loadu_ps(filter + i)));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(samples + i + 4), _mm_loadu_ps(filter + i + 4)));
+    }
+
+    __m128 sum = _mm_add_ps(sum0, sum1);
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+
+    return _mm_cvtss_f32(sum);
+#else
+    float sum = 0.0f;
+    for (int i = 0; i < AUDIO_RESAMPLER_TAPS; ++i) {
+        sum += samples[i] * filter[i];
+    }
+
+    return sum;
+#endif
+}
+
+/* PRIVATE */
+class AudioConverter::Impl {
+    friend class AudioConverter;
+
+public:
+    void buildFilters();
+    void readInput(const uint8_t* input, size_t frames);
+    size_t resample(size_t start);
+    void writeOutput(const float* const channels[AUDIO_CONVERTER_MAX_CHANNELS], size_t frames, uint8_t* output) const;
+    size_t processBlock(const uint8_t* input, size_t frames, uint8_t* output);
+
+private:
+    Format m_input;
+    Format m_output;
+    size_t m_blockFrames = 0;
+    bool m_initialized = false;
+
+    // Rates ratio as up and down factors, 1 / 1 if resampling is not needed
+    int m_up = 1;
+    int m_down = 1;
+    int m_filterPhases = 0;
+    std::vector<float> m_filters; // m_filterPhases filters of AUDIO_RESAMPLER_TAPS coefficients
+
+    // Input samples in output channel layout, AUDIO_RESAMPLER_HALF_TAPS - 1 samples of history first
+    std::array<std::vector<float>, AUDIO_CONVERTER_MAX_CHANNELS> m_history;
+    size_t m_historySize = 0;
+    size_t m_position = 0; // Input sample under the filter centre of the next output frame
+    int m_phase = 0; // Fractional part of the position in 1 / m_up units
+
+    std::array<std::vector<float>, AUDIO_CONVERTER_MAX_CHANNELS> m_resampled;
+};
+
+/**
+ * Filter p delays the signal by p / m_filterPhases input samples, each filter has a unity DC gain.
+ */
+void AudioConverter::Impl::buildFilters()
+{
+    m_filterPhases = std::min(m_up, AUDIO_RESAMPLER_MAX_PHASES);
+    m_filters.assign(size_t(m_filterPhases) * AUDIO_RESAMPLER_TAPS, 0.0f);
+
+    // Downsampling lowers the cutoff to the output Nyquist frequency
+    double cutoff = 0.5 * AUDIO_RESAMPLER_ROLLOFF * std::min(1.0, double(m_output.sampleRate) / m_input.sampleRate);
+    for (int phase = 0; phase < m_filterPhases; ++phase) {
+        float* filter = m_filters.data() + size_t(phase) * AUDIO_RESAMPLER_TAPS;
+        double offset = double(phase) / m_filterPhases;
+
+        double sum = 0.0;
+        std::array<double, AUDIO_RESAMPLER_TAPS> coefficients;
+        for (int tap = 0; tap < AUDIO_RESAMPLER_TAPS; ++tap) {
+            coefficients[tap] = windowedSinc(tap - (AUDIO_RESAMPLER_HALF_TAPS - 1) - offset, cutoff);
+            sum += coefficients[tap];
+        }
+
+        for (int tap = 0; tap < AUDIO_RESAMPLER_TAPS; ++tap) {
+            filter[tap] = float(coefficients[tap] / sum);
+        }
+    }
+}
+
+/**
+ * Converts input frames to float in the output channel layout, appended to the history when resampling.
+ */
+void AudioConverter::Impl::readInput(const uint8_t* input, size_t frames)
+{
+    size_t start = m_up == m_down ? 0 : m_historySize;
+    int inChannels = m_input.channels;
+    int outChannels = m_output.channels;
+    float* left = m_history[0].data() + start;
+    float* right = outChannels == 2 ? m_history[1].data() + start : left;
+
+    size_t i = 0;
+#ifdef OFNX_SIMD_SSE2
+    if (m_input.sampleFormat == SF_INT16) {
+        const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        if (inChannels == 1) {
+            for (; i + 8 <= frames; i += 8) {
+                __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 2 * i));
+                __m128 low = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16)), scale);
+                __m128 high = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16)), scale);
+                _mm_storeu_ps(left + i, low);
+                _mm_storeu_ps(left + i + 4, high);
+                if (outChannels == 2) {
+                    _mm_storeu_ps(right + i, low);
+                    _mm_storeu_ps(right + i + 4, high);
+                }
+            }
+        } else {
+            for (; i + 4 <= frames; i += 4) {
+                __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 4 * i));
+                __m128 low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+                __m128 high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16));
+                __m128 l = _mm_mul_ps(_mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)), scale);
+                __m128 r = _mm_mul_ps(_mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)), scale);
+                if (outChannels == 2) {
+                    _mm_storeu_ps(left + i, l);
+                    _mm_storeu_ps(right + i, r);
+                } else {
+                    _mm_storeu_ps(left + i, _mm_mul_ps(_mm_add_ps(l, r), half));
+                }
+            }
+        }
+    }
+#endif
+
+    size_t inSample = sampleBytes(m_input.sampleFormat);
+    for (; i < frames; ++i) {
+        const uint8_t* frame = input + i * inSample * inChannels;
+        float l = readSample(frame, m_input.sampleFormat);
+        float r = inChannels == 2 ? readSample(frame + inSample, m_input.sampleFormat) : l;
+        if (outChannels == 2) {
+            left[i] = l;
+            right[i] = r;
+        } else {
+            left[i] = inChannels == 2 ? (l + r) * 0.5f : l;
+        }
+    }
+}
+
+/**
+ * Filters the history from start, then drops the samples no longer needed.
+ * @return Frames written to m_resampled.
+ */
+size_t AudioConverter::Impl::resample(size_t start)
+{
+    m_historySize = start;
+
+    size_t frames = 0;
+    while (m_position + AUDIO_RESAMPLER_HALF_TAPS < m_historySize) {
+        int filterIndex = m_filterPhases == m_up ? m_phase : int(int64_t(m_phase) * m_filterPhases / m_up);
+        const float* filter = m_filters.data() + size_t(filterIndex) * AUDIO_RESAMPLER_TAPS;
+        size_t first = m_position - (AUDIO_RESAMPLER_HALF_TAPS - 1);
+        for (int c = 0; c < m_output.channels; ++c) {
+            m_resampled[c][frames] = dotProduct(m_history[c].data() + first, filter);
+        }
+        ++frames;
+
+        m_phase += m_down;
+        m_position += m_phase / m_up;
+        m_phase %= m_up;
+    }
+
+    // Keep the filter history of the next output frame, or skip input when downsampling went past it
+    size_t consumed = std::min(m_position - (AUDIO_RESAMPLER_HALF_TAPS - 1), m_historySize);
+    for (int c = 0; c < m_output.channels; ++c) {
+        std::copy(m_history[c].begin() + consumed, m_history[c].begin() + m_historySize, m_history[c].begin());
+    }
+    m_historySize -= consumed;
+    m_position -= consumed;
+
+    return frames;
+}
+
+/**
+ * Interleaves and converts planar float frames to the output format.
+ */
+void AudioConverter::Impl::writeOutput(const float* const channels[AUDIO_CONVERTER_MAX_CHANNELS], size_t frames, uint8_t* output) const
+{
+    const float* left = channels[0];
+    const float* right = channels[1];
+    bool stereo = m_output.channels == 2;
+
+    size_t i = 0;
+#ifdef OFNX_SIMD_SSE2
+    if (m_output.sampleFormat == SF_INT16) {
+        // Rounded and saturated by the conversion and pack instructions
+        const __m128 scale = _mm_set1_ps(32768.0f);
+        if (!stereo) {
+            for (; i + 8 <= frames; i += 8) {
+                __m128i low = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(left + i), scale));
+                __m128i high = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(left + i + 4), scale));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 2 * i), _mm_packs_epi32(low, high));
+            }
+        } else {
+            for (; i + 4 <= frames; i += 4) {
+                __m128 l = _mm_loadu_ps(left + i);
+                __m128 r = _mm_loadu_ps(right + i);
+                __m128i low = _mm_cvtps_epi32(_mm_mul_ps(_mm_unpacklo_ps(l, r), scale));
+                __m128i high = _mm_cvtps_epi32(_mm_mul_ps(_mm_unpackhi_ps(l, r), scale));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 4 * i), _mm_packs_epi32(low, high));
+            }
+        }
+    } else if (m_output.sampleFormat == SF_FLOAT && stereo) {
+        for (; i + 4 <= frames; i += 4) {
+            __m128 l = _mm_loadu_ps(left + i);
+            __m128 r = _mm_loadu_ps(right + i);
+            _mm_storeu_ps(reinterpret_cast<float*>(output + 8 * i), _mm_unpacklo_ps(l, r));
+            _mm_storeu_ps(reinterpret_cast<float*>(output + 8 * i + 16), _mm_unpackhi_ps(l, r));
+        }
+    }
+#endif
+
+    size_t outSample = sampleBytes(m_output.sampleFormat);
+    for (; i < frames; ++i) {
+        uint8_t* frame = output + i * outSample * m_output.channels;
+        writeSample(frame, left[i], m_output.sampleFormat);
+        if (stereo) {
+            writeSample(frame + outSample, right[i], m_output.sampleFormat);
+        }
+    }
+}
+
+/**
+ * Converts at most m_blockFrames frames.
+ * @return Frames written to output.
+ */
+size_t AudioConverter::Impl::processBlock(const uint8_t* input, size_t frames, uint8_t* output)
+{
+    readInput(input, frames);
+
+    if (m_up == m_down) {
+        const float* channels[AUDIO_CONVERTER_MAX_CHANNELS] = { m_history[0].data(), m_history[1].data() };
+        writeOutput(channels, frames, output);
+        return frames;
+    }
+
+    size_t resampled = resample(m_historySize + frames);
+    const float* channels[AUDIO_CONVERTER_MAX_CHANNELS] = { m_resampled[0].data(), m_resampled[1].data() };
+    writeOutput(channels, resampled, output);
+
+    return resampled;
+}
+
+/* PUBLIC */
+AudioConverter::AudioConverter()
+{
+    d_ptr = new Impl;
+}
+
+AudioConverter::~AudioConverter()
+{
+    delete d_ptr;
+}
+
+bool AudioConverter::init(const Format& input, const Format& output, int blockFrames)
+{
+    d_ptr->m_initialized = false;
+
+    if (!isValid(input) || !isValid(output)) {
+        LOG_ERROR("Unsupported audio format");
+        return false;
+    }
+
+    if (blockFrames <= 0 || blockFrames > AUDIO_CONVERTER_MAX_BLOCK) {
+        LOG_ERROR("Invalid block size: {}", blockFrames);
+        return false;
+    }
+
+    d_ptr->m_input = input;
+    d_ptr->m_output = output;
+    d_ptr->m_blockFrames = blockFrames;
+
+    int divisor = std::gcd(input.sampleRate, output.sampleRate);
+    d_ptr->m_up = output.sampleRate / divisor;
+    d_ptr->m_down = input.sampleRate / divisor;
+
+    // History of the first output frame, then a block of input and the frames it produces
+    size_t historyCapacity = d_ptr->m_blockFrames;
+    if (d_ptr->m_up != d_ptr->m_down) {
+        d_ptr->buildFilters();
+        historyCapacity += 2 * AUDIO_RESAMPLER_TAPS;
+    } else {
+        d_ptr->m_filters.clear();
+        d_ptr->m_filterPhases = 0;
+    }
+
+    size_t resampledCapacity = d_ptr->m_up == d_ptr->m_down ? 0 : maxOutputFrames(std::max<size_t>(d_ptr->m_blockFrames, AUDIO_RESAMPLER_HALF_TAPS));
+    for (int c = 0; c < AUDIO_CONVERTER_MAX_CHANNELS; ++c) {
+        bool used = c < output.channels;
+        d_ptr->m_history[c].assign(used ? historyCapacity : 0, 0.0f);
+        d_ptr->m_resampled[c].assign(used ? resampledCapacity : 0, 0.0f);
+    }
+
+    d_ptr->m_initialized = true;
+    reset();
+
+    return true;
+}
+
+void AudioConverter::reset()
+{
+    // The first output frame is centred on the first input sample, with silence before it
+    d_ptr->m_historySize = AUDIO_RESAMPLER_HALF_TAPS - 1;
+    d_ptr->m_position = AUDIO_RESAMPLER_HALF_TAPS - 1;
+    d_ptr->m_phase = 0;
+    for (std::vector<float>& history : d_ptr->m_history) {
+        std::fill_n(history.begin(), std::min<size_t>(history.size(), d_ptr->m_historySize), 0.0f);
+    }
+}
+
+const AudioConverter::Format& AudioConverter::getInputFormat() const
+{
+    return d_ptr->m_input;
+}
+
+const AudioConverter::Format& AudioConverter::getOutputFormat() const
+{
+    return d_ptr->m_output;
+}
+
+size_t AudioConverter::maxOutputFrames(size_t inputFrames) const
+{
+    if (d_ptr->m_up == d_ptr->m_down) {
+        return inputFrames;
+    }
+
+    // Frames held back by earlier calls are covered by the extra history
+    return (inputFrames + AUDIO_RESAMPLER_TAPS) * uint64_t(d_ptr->m_up) / d_ptr->m_down + 1;
+}
+
+bool AudioConverter::convert(std::span<const uint8_t> input, std::span<uint8_t> output, size_t& outputSize)
+{
+    outputSize = 0;
+
+    if (!d_ptr->m_initialized) {
+        LOG_ERROR("Audio converter not initialized");
+        return false;
+    }
+
+    size_t inFrameBytes = sampleBytes(d_ptr->m_input.sampleFormat) * d_ptr->m_input.channels;
+    size_t outFrameBytes = sampleBytes(d_ptr->m_output.sampleFormat) * d_ptr->m_output.channels;
+    if (input.size() % inFrameBytes != 0) {
+        LOG_ERROR("Partial audio frame");
+        return false;
+    }
+
+    size_t frames = input.size() / inFrameBytes;
+    if (output.size() < maxOutputFrames(frames) * outFrameBytes) {
+        LOG_ERROR("Audio output too small: {} bytes needed", maxOutputFrames(frames) * outFrameBytes);
+        return false;
+    }
+
+    for (size_t done = 0; done < frames;) {
+        size_t blockFrames = std::min(d_ptr->m_blockFrames, frames - done);
+        size_t written = d_ptr->processBlock(input.data() + done * inFrameBytes, blockFrames, output.data() + outputSize);
+        outputSize += written * outFrameBytes;
+        done += blockFrames;
+    }
+
+    return true;
+}
+
+bool AudioConverter::flush(std::span<uint8_t> output, size_t& outputSize)
+{
+    outputSize = 0;
+
+    if (!d_ptr->m_initialized) {
+        LOG_ERROR("Audio converter not initialized");
+        return false;
+    }
+
+    if (d_ptr->m_up == d_ptr->m_down) {
+        return true;
+    }
+
+    size_t outFrameBytes = sampleBytes(d_ptr->m_output.sampleFormat) * d_ptr->m_output.channels;
+    if (output.size() < maxOutputFrames(AUDIO_RESAMPLER_HALF_TAPS) * outFrameBytes) {
+        LOG_ERROR("Audio output too small: {} bytes needed", maxOutputFrames(AUDIO_RESAMPLER_HALF_TAPS) * outFrameBytes);
+        return false;
+    }
+
+    // Silence past the end lets the filter reach the last input samples
+    for (int c = 0; c < d_ptr->m_output.channels; ++c) {
+        std::fill_n(d_ptr->m_history[c].begin() + d_ptr->m_historySize, AUDIO_RESAMPLER_HALF_TAPS, 0.0f);
+    }
+
+    size_t resampled = d_ptr->resample(d_ptr->m_historySize + AUDIO_RESAMPLER_HALF_TAPS);
+    const float* channels[AUDIO_CONVERTER_MAX_CHANNELS] = { d_ptr->m_resampled[0].data(), d_ptr->m_resampled[1].data() };
+    d_ptr->writeOutput(channels, resampled, output.data());
+    outputSize = resampled * outFrameBytes;
+
+    reset();
+
+    return true;
+}
+
+} // namespace ofnx::audio
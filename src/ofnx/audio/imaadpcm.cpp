@@ -0,0 +1,353 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "ofnx/audio/imaadpcm.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "ofnx/tools/log.h"
+#include "ofnx/tools/simd.h"
+
+namespace ofnx::audio {
+
+#define IMA_ADPCM_MAX_INDEX 88
+#define IMA_ADPCM_LANES 8 // Streams decoded together by the SSE2 path
+#define IMA_ADPCM_BLOCK_SIZE 8 // Input bytes per stream and iteration of the SSE2 path
+
+/* Helper functions */
+constexpr int8_t INDEX_TABLE[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+constexpr int16_t STEP_TABLE[IMA_ADPCM_MAX_INDEX + 1] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+/**
+ * Keeps states read from files in range, the step table is indexed without further checks.
+ */
+void sanitize(ImaAdpcm::State& state)
+{
+    state.predictor = std::clamp(state.predictor, -32768, 32767);
+    state.index = std::clamp(state.index, 0, IMA_ADPCM_MAX_INDEX);
+}
+
+/**
+ * Decodes one nibble, sign and clamping compile to masks and conditional moves.
+ */
+inline int decodeNibble(int nibble, ImaAdpcm::State& state)
+{
+    int step = STEP_TABLE[state.index];
+    int diff = ((2 * (nibble & 7) + 1) * step) >> 4;
+    int sign = -(nibble >> 3); // 0 or -1
+
+    state.predictor = std::clamp(state.predictor + ((diff ^ sign) - sign), -32768, 32767);
+    state.index = std::clamp(state.index + INDEX_TABLE[nibble], 0, IMA_ADPCM_MAX_INDEX);
+
+    return state.predictor;
+}
+
+inline void writeSample(uint8_t* output, int sample)
+{
+    if constexpr (std::endian::native == std::endian::little) {
+        int16_t value = int16_t(sample);
+        std::memcpy(output, &value, 2);
+    } else {
+        output[0] = uint8_t(sample);
+        output[1] = uint8_t(sample >> 8);
+    }
+}
+
+void decodeScalar(const uint8_t* input, size_t size, uint8_t* output, ImaAdpcm::State& state)
+{
+    // Local copy, byte stores could alias the caller's state and force reloads
+    ImaAdpcm::State current = state;
+    for (size_t i = 0; i < size; ++i) {
+        uint8_t byte = input[i];
+        writeSample(output, decodeNibble(byte & 0x0F, current));
+        writeSample(output + 2, decodeNibble(byte >> 4, current));
+        output += 4;
+    }
+
+    state = current;
+}
+
+#ifdef OFNX_SIMD_SSE2
+/**
+ * Transposes 8x8 16 bits values.
+ */
+void transpose8x8(__m128i rows[8])
+{
+    __m128i a0 = _mm_unpacklo_epi16(rows[0], rows[1]);
+    __m128i a1 = _mm_unpackhi_epi16(rows[0], rows[1]);
+    __m128i a2 = _mm_unpacklo_epi16(rows[2], rows[3]);
+    __m128i a3 = _mm_unpackhi_epi16(rows[2], rows[3]);
+    __m128i a4 = _mm_unpacklo_epi16(rows[4], rows[5]);
+    __m128i a5 = _mm_unpackhi_epi16(rows[4], rows[5]);
+    __m128i a6 = _mm_unpacklo_epi16(rows[6], rows[7]);
+    __m128i a7 = _mm_unpackhi_epi16(rows[6], rows[7]);
+
+    __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+    __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+    __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+    __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+    __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+    __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+    __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+    __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+    rows[0] = _mm_unpacklo_epi64(b0, b4);
+    rows[1] = _mm_unpackhi_epi64(b0, b4);
+    rows[2] = _mm_unpacklo_epi64(b1, b5);
+    rows[3] = _mm_unpackhi_epi64(b1, b5);
+    rows[4] = _mm_unpacklo_epi64(b2, b6);
+    rows[5] = _mm_unpackhi_epi64(b2, b6);
+    rows[6] = _mm_unpacklo_epi64(b3, b7);
+    rows[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+/**
+ * Decodes one nibble of each lane.
+ * The step product fits 16 bits once shifted and sign/clamping map to saturated additions,
+ * so the only lane by lane work is the step table lookup.
+ */
+inline __m128i decodeNibbles(__m128i nibbles, __m128i& predictor, __m128i& index, __m128i& step)
+{
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i three = _mm_set1_epi16(3);
+    const __m128i six = _mm_set1_epi16(6);
+    const __m128i seven = _mm_set1_epi16(7);
+    const __m128i maxIndex = _mm_set1_epi16(IMA_ADPCM_MAX_INDEX);
+
+    __m128i magnitude = _mm_and_si128(nibbles, seven);
+    __m128i sign = _mm_cmpgt_epi16(nibbles, seven);
+
+    // ((2 * magnitude + 1) * step) >> 4
+    __m128i factor = _mm_slli_epi16(_mm_add_epi16(_mm_add_epi16(magnitude, magnitude), one), 12);
+    __m128i diff = _mm_mulhi_epu16(step, factor);
+    predictor = _mm_adds_epi16(predictor, _mm_sub_epi16(_mm_xor_si128(diff, sign), sign));
+
+    // Index table: -1 below 4, 2 * magnitude - 6 otherwise
+    __m128i large = _mm_cmpgt_epi16(magnitude, three);
+    __m128i delta = _mm_or_si128(
+        _mm_and_si128(large, _mm_sub_epi16(_mm_add_epi16(magnitude, magnitude), six)),
+        _mm_andnot_si128(large, _mm_set1_epi16(-1)));
+    index = _mm_min_epi16(_mm_max_epi16(_mm_add_epi16(index, delta), _mm_setzero_si128()), maxIndex);
+
+    step = _mm_setr_epi16(
+        STEP_TABLE[_mm_extract_epi16(index, 0)], STEP_TABLE[_mm_extract_epi16(index, 1)],
+        STEP_TABLE[_mm_extract_epi16(index, 2)], STEP_TABLE[_mm_extract_epi16(index, 3)],
+        STEP_TABLE[_mm_extract_epi16(index, 4)], STEP_TABLE[_mm_extract_epi16(index, 5)],
+        STEP_TABLE[_mm_extract_epi16(index, 6)], STEP_TABLE[_mm_extract_epi16(index, 7)]);
+
+    return predictor;
+}
+
+/**
+ * Decodes size bytes (multiple of IMA_ADPCM_BLOCK_SIZE) of 8 streams in lockstep.
+ * @param advances 1 for lanes moving through their data, 0 for padding lanes reusing the same block.
+ */
+void decodeLanesSse2(const uint8_t* inputs[IMA_ADPCM_LANES], uint8_t* outputs[IMA_ADPCM_LANES],
+    const size_t advances[IMA_ADPCM_LANES], size_t size, ImaAdpcm::State states[IMA_ADPCM_LANES])
+{
+    alignas(16) int16_t values[2][IMA_ADPCM_LANES];
+    for (int lane = 0; lane < IMA_ADPCM_LANES; ++lane) {
+        values[0][lane] = int16_t(states[lane].predictor);
+        values[1][lane] = int16_t(states[lane].index);
+    }
+
+    __m128i predictor = _mm_load_si128(reinterpret_cast<const __m128i*>(values[0]));
+    __m128i index = _mm_load_si128(reinterpret_cast<const __m128i*>(values[1]));
+    __m128i step = _mm_setr_epi16(
+        STEP_TABLE[values[1][0]], STEP_TABLE[values[1][1]], STEP_TABLE[values[1][2]], STEP_TABLE[values[1][3]],
+        STEP_TABLE[values[1][4]], STEP_TABLE[values[1][5]], STEP_TABLE[values[1][6]], STEP_TABLE[values[1][7]]);
+
+    const __m128i lowNibble = _mm_set1_epi16(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (size_t offset = 0; offset < size; offset += IMA_ADPCM_BLOCK_SIZE) {
+        // Transpose the next 8 bytes of every lane, pairs[i] holds bytes 2i and 2i + 1 of lanes 0 to 7
+        __m128i rows[IMA_ADPCM_LANES];
+        for (int lane = 0; lane < IMA_ADPCM_LANES; ++lane) {
+            rows[lane] = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(inputs[lane] + offset * advances[lane]));
+        }
+
+        __m128i t0 = _mm_unpacklo_epi8(rows[0], rows[1]);
+        __m128i t1 = _mm_unpacklo_epi8(rows[2], rows[3]);
+        __m128i t2 = _mm_unpacklo_epi8(rows[4], rows[5]);
+        __m128i t3 = _mm_unpacklo_epi8(rows[6], rows[7]);
+        __m128i u0 = _mm_unpacklo_epi16(t0, t1);
+        __m128i u1 = _mm_unpackhi_epi16(t0, t1);
+        __m128i u2 = _mm_unpacklo_epi16(t2, t3);
+        __m128i u3 = _mm_unpackhi_epi16(t2, t3);
+        __m128i pairs[4] = {
+            _mm_unpacklo_epi32(u0, u2),
+            _mm_unpackhi_epi32(u0, u2),
+            _mm_unpacklo_epi32(u1, u3),
+            _mm_unpackhi_epi32(u1, u3),
+        };
+
+        // samples[j] holds sample j of the block for lanes 0 to 7
+        __m128i samples[2 * IMA_ADPCM_BLOCK_SIZE];
+        for (int i = 0; i < IMA_ADPCM_BLOCK_SIZE; ++i) {
+            __m128i bytes = (i & 1) ? _mm_unpackhi_epi8(pairs[i / 2], zero) : _mm_unpacklo_epi8(pairs[i / 2], zero);
+            samples[2 * i] = decodeNibbles(_mm_and_si128(bytes, lowNibble), predictor, index, step);
+            samples[2 * i + 1] = decodeNibbles(_mm_srli_epi16(bytes, 4), predictor, index, step);
+        }
+
+        transpose8x8(samples);
+        transpose8x8(samples + IMA_ADPCM_LANES);
+        for (int lane = 0; lane < IMA_ADPCM_LANES; ++lane) {
+            uint8_t* output = outputs[lane] + 4 * offset * advances[lane];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output), samples[lane]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 16), samples[IMA_ADPCM_LANES + lane]);
+        }
+    }
+
+    _mm_store_si128(reinterpret_cast<__m128i*>(values[0]), predictor);
+    _mm_store_si128(reinterpret_cast<__m128i*>(values[1]), index);
+    for (int lane = 0; lane < IMA_ADPCM_LANES; ++lane) {
+        states[lane].predictor = values[0][lane];
+        states[lane].index = values[1][lane];
+    }
+}
+#endif
+
+/* PUBLIC */
+bool ImaAdpcm::decodeMono(std::span<const uint8_t> input, std::span<uint8_t> output, State& state)
+{
+    if (output.size() < input.size() * 4) {
+        LOG_ERROR("ADPCM output too small");
+        return false;
+    }
+
+    sanitize(state);
+    decodeScalar(input.data(), input.size(), output.data(), state);
+
+    return true;
+}
+
+bool ImaAdpcm::decodeStereo(
+    std::span<const uint8_t> left, std::span<const uint8_t> right,
+    std::span<uint8_t> output,
+    State& leftState, State& rightState)
+{
+    if (left.size() != right.size() || output.size() < left.size() * 8) {
+        LOG_ERROR("Invalid ADPCM stereo buffers");
+        return false;
+    }
+
+    sanitize(leftState);
+    sanitize(rightState);
+
+    // Both channels in the same loop, their dependency chains overlap
+    State leftCurrent = leftState;
+    State rightCurrent = rightState;
+    uint8_t* data = output.data();
+    for (size_t i = 0; i < left.size(); ++i) {
+        uint8_t leftByte = left[i];
+        uint8_t rightByte = right[i];
+        writeSample(data, decodeNibble(leftByte & 0x0F, leftCurrent));
+        writeSample(data + 2, decodeNibble(rightByte & 0x0F, rightCurrent));
+        writeSample(data + 4, decodeNibble(leftByte >> 4, leftCurrent));
+        writeSample(data + 6, decodeNibble(rightByte >> 4, rightCurrent));
+        data += 8;
+    }
+
+    leftState = leftCurrent;
+    rightState = rightCurrent;
+
+    return true;
+}
+
+bool ImaAdpcm::decodeStreams(std::span<Stream> streams)
+{
+    for (Stream& stream : streams) {
+        if (stream.output.size() < stream.input.size() * 4) {
+            LOG_ERROR("ADPCM output too small");
+            return false;
+        }
+
+        sanitize(stream.state);
+    }
+
+    size_t done = 0;
+#ifdef OFNX_SIMD_SSE2
+    // Groups of streams are decoded in lockstep up to their shortest length, missing lanes decode silence
+    // Single streams gain nothing from it
+    alignas(16) uint8_t silence[IMA_ADPCM_BLOCK_SIZE] = { 0 };
+    alignas(16) uint8_t discard[4 * IMA_ADPCM_BLOCK_SIZE];
+    for (size_t first = 0; first + 1 < streams.size(); first += IMA_ADPCM_LANES) {
+        size_t count = std::min<size_t>(IMA_ADPCM_LANES, streams.size() - first);
+
+        size_t size = SIZE_MAX;
+        for (size_t i = 0; i < count; ++i) {
+            size = std::min(size, streams[first + i].input.size());
+        }
+        size -= size % IMA_ADPCM_BLOCK_SIZE;
+
+        const uint8_t* inputs[IMA_ADPCM_LANES];
+        uint8_t* outputs[IMA_ADPCM_LANES];
+        size_t advances[IMA_ADPCM_LANES];
+        State states[IMA_ADPCM_LANES];
+        for (size_t lane = 0; lane < IMA_ADPCM_LANES; ++lane) {
+            bool used = lane < count;
+            inputs[lane] = used ? streams[first + lane].input.data() : silence;
+            outputs[lane] = used ? streams[first + lane].output.data() : discard;
+            advances[lane] = used ? 1 : 0;
+            states[lane] = used ? streams[first + lane].state : State();
+        }
+
+        decodeLanesSse2(inputs, outputs, advances, size, states);
+
+        for (size_t i = 0; i < count; ++i) {
+            Stream& stream = streams[first + i];
+            stream.state = states[i];
+            decodeScalar(stream.input.data() + size, stream.input.size() - size, stream.output.data() + 4 * size, stream.state);
+        }
+
+        done = first + count;
+    }
+#endif
+
+    for (size_t i = done; i < streams.size(); ++i) {
+        Stream& stream = streams[i];
+        decodeScalar(stream.input.data(), stream.input.size(), stream.output.data(), stream.state);
+    }
+
+    return true;
+}
+
+} // namespace ofnx::audio
@@ -25,20 +25,124 @@ SOFTWARE.
 #include "ofnx/files/4xm.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
 #include <iostream>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+#include "ofnx/audio/imaadpcm.h"
+#include "ofnx/graphics/fxmdecoder.h"
 #include "ofnx/tools/datastream.h"
 #include "ofnx/tools/log.h"
+#include "ofnx/tools/randomaccessfile.h"
 
 namespace ofnx::files {
 
+#define FXM_CFRAME_BUFFER_COUNT 16 // Frames being reassembled at the same time
+#define FXM_CFRAME_MAX_SIZE (1 << 26)
+
+/* Helper functions */
+uint32_t readLe32(std::span<const uint8_t> data, size_t offset)
+{
+    return uint32_t(data[offset]) | (uint32_t(data[offset + 1]) << 8)
+        | (uint32_t(data[offset + 2]) << 16) | (uint32_t(data[offset + 3]) << 24);
+}
+
+uint16_t readLe16(std::span<const uint8_t> data, size_t offset)
+{
+    return uint16_t(data[offset] | (data[offset + 1] << 8));
+}
+
+/**
+ * Reads the file data in place, positions are clamped to the end and reads past it return zeros.
+ */
+class FxmCursor {
+public:
+    void reset(std::span<const uint8_t> data, uint64_t position = 0)
+    {
+        m_data = data;
+        seek(position);
+    }
+
+    uint64_t tell() const
+    {
+        return m_position;
+    }
+
+    bool atEnd() const
+    {
+        return m_position >= m_data.size();
+    }
+
+    void seek(uint64_t position)
+    {
+        m_position = std::min<uint64_t>(position, m_data.size());
+    }
+
+    void skip(uint64_t size)
+    {
+        seek(m_position + size);
+    }
+
+    void read(void* output, size_t size)
+    {
+        std::span<const uint8_t> bytes = view(size);
+        std::memcpy(output, bytes.data(), bytes.size());
+        std::memset(static_cast<uint8_t*>(output) + bytes.size(), 0, size - bytes.size());
+    }
+
+    uint32_t readUint32()
+    {
+        uint8_t bytes[4];
+        read(bytes, 4);
+
+        return readLe32(bytes, 0);
+    }
+
+    /**
+     * Returns the next bytes without copy, truncated at the end of the data.
+     */
+    std::span<const uint8_t> view(size_t size)
+    {
+        std::span<const uint8_t> bytes = m_data.subspan(m_position, std::min<uint64_t>(size, m_data.size() - m_position));
+        m_position += bytes.size();
+
+        return bytes;
+    }
+
+private:
+    std::span<const uint8_t> m_data;
+    uint64_t m_position = 0;
+};
+
+Fxm::Chunk& nextVideoChunk(Fxm::Packet& packet)
+{
+    if (size_t(packet.videoCount) == packet.video.size()) {
+        packet.video.emplace_back();
+    }
+
+    return packet.video[packet.videoCount++];
+}
+
 /* PRIVATE */
 class Fxm::Impl {
     friend class Fxm;
 
 public:
+    struct FrameFragments {
+        uint32_t id = 0;
+        uint32_t wholeSize = 0;
+        size_t size = 0; // Bytes received, data is never shrunk
+        std::vector<uint8_t> data;
+    };
+
+    bool openData();
+
+    uint32_t readUint32();
     uint32_t readChunkList();
     std::string readChunkString(const char* checkStr);
 
@@ -50,19 +154,157 @@ public:
     bool readTrk_();
     bool readMovi();
 
+    void startIndexing();
+    void stopIndexing();
+    void indexFrames();
+    bool waitForFrame(int frame) const;
+    int frameCount() const;
+
+    bool readFragment(uint32_t chunkSize, FrameFragments*& complete);
+    bool readPacket(Packet& packet, bool withSound);
+    bool decodeVideo(const Packet& packet, std::vector<uint16_t>* dataVideo);
+    size_t soundSize(const Packet& packet) const;
+    bool decodeSound(const Packet& packet, std::span<uint8_t> dataAudio) const;
+    void copyFrame(std::span<uint16_t> output, int pitch) const;
+
 private:
-    std::fstream m_file;
+    ofnx::tools::RandomAccessFile m_file; // Mapped, unused for in memory sources
+    std::shared_ptr<const std::vector<uint8_t>> m_sharedData; // In memory sources
+    std::span<const uint8_t> m_data; // Whole file, read-only while open
+    FxmCursor m_cursor; // Playback position
 
     std::string m_name;
     std::string m_info;
     uint32_t m_dataRate;
     uint32_t m_frameRate;
-    int m_frameCount;
+    int m_currentFrame = 0; // Next frame returned by readFrame
+
+    uint64_t m_moviDataOffset = 0;
+    uint64_t m_moviEnd = 0;
+
+    // Frame index, filled by the indexing thread after open
+    std::thread m_indexThread;
+    mutable std::mutex m_indexMutex;
+    mutable std::condition_variable m_indexCondition;
+    std::atomic_bool m_indexStop = false;
+    bool m_indexComplete = true;
+    std::vector<FrameInfo> m_frameIndex;
 
     std::vector<TrackVideo> m_videoTracks;
     std::vector<TrackSound> m_soundTracks;
+
+    ofnx::graphics::FxmDecoder m_decoder;
+    std::array<FrameFragments, FXM_CFRAME_BUFFER_COUNT> m_fragments;
+
+    Packet m_packet; // Used by readFrame and seeking
 };
 
+/**
+ * Parses the headers of m_data and starts indexing its frames.
+ */
+bool Fxm::Impl::openData()
+{
+    m_videoTracks.clear();
+    m_soundTracks.clear();
+    m_cursor.reset(m_data);
+
+    if (!readRiff() || !readHead() || !readTrk_() || !readMovi()) {
+        return false;
+    }
+
+    if (!m_videoTracks.empty()) {
+        const TrackVideo& track = m_videoTracks[0];
+        m_decoder.init(track.width, track.height, track.version);
+    }
+
+    // Playback reads the movie forward, seeking adds its own hints
+    m_file.advise(m_moviDataOffset, m_moviEnd - m_moviDataOffset, ofnx::tools::RandomAccessFile::Advice::SEQUENTIAL);
+
+    startIndexing();
+
+    return true;
+}
+
+/**
+ * Reads a little endian 32 bits value from the file.
+ */
+uint32_t Fxm::Impl::readUint32()
+{
+    return m_cursor.readUint32();
+}
+
+/**
+ * Reads a cfrm chunk payload straight into the reassembly buffer of its frame.
+ * Buffers keep their capacity, so no allocation happens once they have grown to the largest frame.
+ * @param complete Set to the frame buffer once all its fragments are received.
+ */
+bool Fxm::Impl::readFragment(uint32_t chunkSize, FrameFragments*& complete)
+{
+    complete = nullptr;
+
+    uint64_t chunkEnd = m_cursor.tell() + chunkSize;
+    if (chunkSize < 12) {
+        LOG_ERROR("cfrm chunk too small");
+        m_cursor.seek(chunkEnd);
+        return false;
+    }
+
+    if (m_videoTracks.empty() || m_videoTracks[0].version <= 1) {
+        LOG_ERROR("cfrm chunk in a version 1 stream");
+        m_cursor.seek(chunkEnd);
+        return false;
+    }
+
+    readUint32(); // Unknown
+    uint32_t id = readUint32();
+    uint32_t wholeSize = readUint32();
+    size_t dataSize = chunkSize - 12;
+
+    // Fragments of a few frames may be interleaved
+    FrameFragments* fragments = nullptr;
+    for (FrameFragments& candidate : m_fragments) {
+        if (candidate.size != 0 && candidate.id == id) {
+            fragments = &candidate;
+            break;
+        }
+        if (candidate.size == 0 && fragments == nullptr) {
+            fragments = &candidate;
+        }
+    }
+
+    if (fragments == nullptr) {
+        LOG_ERROR("Too many incomplete cfrm frames");
+        m_cursor.seek(chunkEnd);
+        return false;
+    }
+
+    if (fragments->size == 0) {
+        fragments->id = id;
+        fragments->wholeSize = wholeSize;
+    }
+
+    size_t size = fragments->size + dataSize;
+    if (size > FXM_CFRAME_MAX_SIZE) {
+        LOG_ERROR("cfrm frame too large");
+        fragments->size = 0;
+        m_cursor.seek(chunkEnd);
+        return false;
+    }
+
+    if (fragments->data.size() < size) {
+        fragments->data.resize(std::max<size_t>(size, std::min<size_t>(fragments->wholeSize, FXM_CFRAME_MAX_SIZE)));
+    }
+
+    m_cursor.read(fragments->data.data() + fragments->size, dataSize);
+    fragments->size = size;
+
+    if (fragments->size >= fragments->wholeSize) {
+        complete = fragments;
+    }
+
+    return true;
+}
+
 /**
  * Reads a chunk list from the file.
  * @return The size of the chunk list (0 if invalid).
@@ -70,14 +312,14 @@ private:
 uint32_t Fxm::Impl::readChunkList()
 {
     char chunkList[5] = { 0 };
-    m_file.read(chunkList, 4);
+    m_cursor.read(chunkList, 4);
     if (strcmp(chunkList, "LIST") != 0) {
         LOG_ERROR("Invalid LIST header");
         return 0;
     }
 
     uint32_t chunkListSize = 0;
-    m_file >> chunkListSize;
+    chunkListSize = readUint32();
 
     return chunkListSize;
 }
@@ -89,14 +331,14 @@ uint32_t Fxm::Impl::readChunkList()
 std::string Fxm::Impl::readChunkString(const char* checkStr)
 {
     char chunkName[5] = { 0 };
-    m_file.read(chunkName, 4);
+    m_cursor.read(chunkName, 4);
 
     if (strcmp(chunkName, checkStr) != 0) {
         return std::string();
     }
 
     uint32_t chunkNameSize = 0;
-    m_file >> chunkNameSize;
+    chunkNameSize = readUint32();
 
     if (chunkNameSize % 2 != 0) {
         // There seem to be a pair number of bytes in the chunk name
@@ -105,7 +347,7 @@ std::string Fxm::Impl::readChunkString(const char* checkStr)
     }
 
     std::string name(chunkNameSize, '\0');
-    m_file.read(name.data(), chunkNameSize);
+    m_cursor.read(name.data(), chunkNameSize);
 
     return name;
 }
@@ -117,37 +359,40 @@ bool Fxm::Impl::parseVideoTrack()
 
     // Video track info
     char vtrk[5] = { 0 };
-    m_file.read(vtrk, 4);
+    m_cursor.read(vtrk, 4);
     if (strcmp(vtrk, "vtrk") != 0) {
         LOG_ERROR("Invalid VTRK header");
         return false;
     }
 
-    uint32_t vtrkSize = 0;
-    m_file >> vtrkSize;
+    m_cursor.skip(4); // VTRK size
+
+    char unknown[8] = { 0 };
+    m_cursor.read(unknown, 8);
 
-    char unknown[28] = { 0 };
-    m_file.read(unknown, 28);
+    uint32_t version = readUint32();
+
+    char unknown1[16] = { 0 };
+    m_cursor.read(unknown1, 16);
 
     uint32_t width = 0;
-    m_file >> width;
+    width = readUint32();
 
     uint32_t height = 0;
-    m_file >> height;
+    height = readUint32();
 
-    uint32_t width2 = 0;
-    m_file >> width2;
+    m_cursor.skip(4); // Second width
 
-    uint32_t height2 = 0;
-    m_file >> height2;
+    m_cursor.skip(4); // Second height
 
     char unknown2[24] = { 0 };
-    m_file.read(unknown, 24);
+    m_cursor.read(unknown2, 24);
 
     TrackVideo trackVideo;
     trackVideo.name = name;
     trackVideo.width = width;
     trackVideo.height = height;
+    trackVideo.version = version >> 16;
     m_videoTracks.push_back(trackVideo);
 
     return true;
@@ -160,32 +405,31 @@ bool Fxm::Impl::parseSoundTrack()
 
     // Sound track info
     char strk[5] = { 0 };
-    m_file.read(strk, 4);
+    m_cursor.read(strk, 4);
     if (strcmp(strk, "strk") != 0) {
         LOG_ERROR("Invalid STRK header");
         return false;
     }
 
-    uint32_t strkSize = 0;
-    m_file >> strkSize;
+    m_cursor.skip(4); // STRK size
 
     uint32_t trackNumber = 0;
-    m_file >> trackNumber;
+    trackNumber = readUint32();
 
     uint32_t type = 0;
-    m_file >> type;
+    type = readUint32();
 
     char unknown[20] = { 0 };
-    m_file.read(unknown, 20);
+    m_cursor.read(unknown, 20);
 
     uint32_t channels = 0;
-    m_file >> channels;
+    channels = readUint32();
 
     uint32_t sampleRate = 0;
-    m_file >> sampleRate;
+    sampleRate = readUint32();
 
     uint32_t sampleResolution = 0;
-    m_file >> sampleResolution;
+    sampleResolution = readUint32();
 
     TrackSound trackSound;
     trackSound.name = name;
@@ -203,19 +447,17 @@ bool Fxm::Impl::readRiff()
 {
     // RIFF header
     char riff[5] = { 0 };
-    m_file.read(riff, 4);
+    m_cursor.read(riff, 4);
     if (strcmp(riff, "RIFF") != 0) {
         LOG_ERROR("Invalid RIFF header");
         return false;
     }
 
-    // File size
-    uint32_t fileSize = 0;
-    m_file >> fileSize;
+    m_cursor.skip(4); // File size
 
     // Type
     char type[5] = { 0 };
-    m_file.read(type, 4);
+    m_cursor.read(type, 4);
     if (strcmp(type, "4XMV") != 0) {
         LOG_ERROR("Invalid 4XM header");
         return false;
@@ -234,7 +476,7 @@ bool Fxm::Impl::readHead()
 
     // HEAD header
     char head[5] = { 0 };
-    m_file.read(head, 4);
+    m_cursor.read(head, 4);
     if (strcmp(head, "HEAD") != 0) {
         LOG_ERROR("Invalid HEAD header");
         return false;
@@ -248,7 +490,7 @@ bool Fxm::Impl::readHead()
     }
 
     char hnfo[5] = { 0 };
-    m_file.read(hnfo, 4);
+    m_cursor.read(hnfo, 4);
     if (strcmp(hnfo, "HNFO") != 0) {
         LOG_ERROR("Invalid HNFO header");
         return false;
@@ -262,20 +504,19 @@ bool Fxm::Impl::readHead()
 
     // HNFO std_
     char hnfoStd_[5] = { 0 };
-    m_file.read(hnfoStd_, 4);
+    m_cursor.read(hnfoStd_, 4);
     if (strcmp(hnfoStd_, "std_") != 0) {
         LOG_ERROR("Invalid HNFO std_ header");
         return false;
     }
 
-    uint32_t hnfoStd_Size = 0;
-    m_file >> hnfoStd_Size;
+    m_cursor.skip(4); // HNFO std_ size
 
     uint32_t dataRate = 0;
-    m_file >> dataRate;
+    dataRate = readUint32();
 
     uint32_t frameRate = 0;
-    m_file >> frameRate;
+    frameRate = readUint32();
 
     switch (frameRate) {
     case 0x41700000:
@@ -305,17 +546,17 @@ bool Fxm::Impl::readTrk_()
         return false;
     }
 
-    size_t offsetTrk = m_file.tellg();
+    uint64_t offsetTrk = m_cursor.tell();
 
     // TRK_ header
     char trk_[5] = { 0 };
-    m_file.read(trk_, 4);
+    m_cursor.read(trk_, 4);
     if (strcmp(trk_, "TRK_") != 0) {
         LOG_ERROR("Invalid TRK_ header");
         return false;
     }
 
-    while (m_file.tellg() < offsetTrk + chunkTrk_ListSize) {
+    while (!m_cursor.atEnd() && m_cursor.tell() < offsetTrk + chunkTrk_ListSize) {
         uint32_t chunkSubTrkListSize = readChunkList();
         if (chunkSubTrkListSize == 0) {
             LOG_ERROR("Invalid ?TRK chunk list");
@@ -324,7 +565,7 @@ bool Fxm::Impl::readTrk_()
 
         // ?TRK header
         char subTrk[5] = { 0 };
-        m_file.read(subTrk, 4);
+        m_cursor.read(subTrk, 4);
 
         if (strcmp(subTrk, "VTRK") == 0) {
             if (!parseVideoTrack()) {
@@ -340,7 +581,7 @@ bool Fxm::Impl::readTrk_()
         }
     }
 
-    m_file.seekg(offsetTrk + chunkTrk_ListSize);
+    m_cursor.seek(offsetTrk + chunkTrk_ListSize);
 
     return true;
 }
@@ -353,59 +594,362 @@ bool Fxm::Impl::readMovi()
         return false;
     }
 
-    size_t offsetMovi = m_file.tellg();
+    uint64_t offsetMovi = m_cursor.tell();
 
     // MOVI header
     char movi[5] = { 0 };
-    m_file.read(movi, 4);
+    m_cursor.read(movi, 4);
     if (strcmp(movi, "MOVI") != 0) {
         LOG_ERROR("Invalid MOVI header");
         return false;
     }
 
-    size_t offsetMoviData = m_file.tellg();
-    m_frameCount = 0;
-    while (m_file.tellg() < offsetMovi + chunkMovi_ListSize) {
-        uint32_t chunkSubMoviListSize = readChunkList();
-        if (chunkSubMoviListSize == 0) {
-            LOG_ERROR("Invalid ?MOVI chunk list");
-            return false;
-        }
+    // Frames are indexed in the background, readFrame only needs the data range
+    m_moviDataOffset = m_cursor.tell();
+    m_moviEnd = std::min<uint64_t>(offsetMovi + chunkMovi_ListSize, m_data.size());
+    m_currentFrame = 0;
 
-        size_t curFrameOffset = m_file.tellg();
+    return true;
+}
 
-        char fram[5] = { 0 };
-        m_file.read(fram, 4);
+void Fxm::Impl::startIndexing()
+{
+    stopIndexing();
 
-        if (strcmp(fram, "FRAM") != 0) {
+    {
+        std::lock_guard lock(m_indexMutex);
+        m_frameIndex.clear();
+        m_indexComplete = false;
+    }
+
+    m_indexStop = false;
+    m_indexThread = std::thread(&Impl::indexFrames, this);
+}
+
+void Fxm::Impl::stopIndexing()
+{
+    m_indexStop = true;
+    if (m_indexThread.joinable()) {
+        m_indexThread.join();
+    }
+}
+
+/**
+ * Walks every FRAM list with its own cursor, so playback can start right after open.
+ */
+void Fxm::Impl::indexFrames()
+{
+    FxmCursor file;
+    file.reset(m_data, m_moviDataOffset);
+
+    int frameCount = 0;
+    int keyframe = 0;
+    while (!m_indexStop && file.tell() < m_moviEnd) {
+        FrameInfo info;
+        info.offset = file.tell();
+
+        char list[5] = { 0 };
+        file.read(list, 4);
+        uint32_t chunkSubMoviListSize = file.readUint32();
+        uint64_t curFrameOffset = file.tell();
+
+        char fram[5] = { 0 };
+        file.read(fram, 4);
+        if (strcmp(list, "LIST") != 0 || chunkSubMoviListSize == 0 || strcmp(fram, "FRAM") != 0) {
             LOG_ERROR("Invalid FRAM header");
-            return false;
+            break;
         }
 
-        while (m_file.tellg() < curFrameOffset + chunkSubMoviListSize) {
+        bool valid = true;
+        while (valid && !file.atEnd() && file.tell() < curFrameOffset + chunkSubMoviListSize) {
             char chunkType[5] = { 0 };
-            m_file.read(chunkType, 4);
+            file.read(chunkType, 4);
             std::string chunkTypeStr(chunkType);
 
             uint32_t chunkSize = 0;
-            m_file >> chunkSize;
-
-            if (chunkTypeStr != "ifrm" && chunkTypeStr != "pfrm" && chunkTypeStr != "cfrm" && chunkTypeStr != "snd_") {
+            chunkSize = file.readUint32();
+
+            if (chunkTypeStr == "ifrm") {
+                info.chunks |= CF_IFRM;
+            } else if (chunkTypeStr == "pfrm") {
+                info.chunks |= CF_PFRM;
+            } else if (chunkTypeStr == "cfrm") {
+                info.chunks |= CF_CFRM;
+            } else if (chunkTypeStr == "snd_") {
+                info.chunks |= CF_SOUND;
+            } else {
                 LOG_ERROR("Invalid sub FRM chunk header");
-                return false;
+                valid = false;
+            }
+
+            file.skip(chunkSize);
+        }
+
+        if (!valid) {
+            break;
+        }
+
+        if (info.chunks & CF_IFRM) {
+            keyframe = frameCount;
+        }
+        info.keyframe = keyframe;
+        ++frameCount;
+
+        std::lock_guard lock(m_indexMutex);
+        m_frameIndex.push_back(info);
+        m_indexCondition.notify_all();
+    }
+
+    std::lock_guard lock(m_indexMutex);
+    m_indexComplete = true;
+    m_indexCondition.notify_all();
+}
+
+/**
+ * Blocks until the frame is indexed or indexing is over.
+ * @return True if the frame exists.
+ */
+bool Fxm::Impl::waitForFrame(int frame) const
+{
+    if (frame < 0) {
+        return false;
+    }
+
+    std::unique_lock lock(m_indexMutex);
+    m_indexCondition.wait(lock, [&] { return m_indexComplete || m_frameIndex.size() > size_t(frame); });
+
+    return m_frameIndex.size() > size_t(frame);
+}
+
+/**
+ * Blocks until indexing is over.
+ */
+int Fxm::Impl::frameCount() const
+{
+    std::unique_lock lock(m_indexMutex);
+    m_indexCondition.wait(lock, [&] { return m_indexComplete; });
+
+    return int(m_frameIndex.size());
+}
+
+/**
+ * Reads the chunks of the next FRAM list, cfrm fragments are reassembled into predicted frames.
+ * @param withSound Sound chunks are skipped if false.
+ */
+bool Fxm::Impl::readPacket(Packet& packet, bool withSound)
+{
+    packet.videoCount = 0;
+    packet.sound.type = 0;
+
+    if (m_cursor.tell() >= m_moviEnd) {
+        return false;
+    }
+
+    uint32_t chunkSubMoviListSize = readChunkList();
+    if (chunkSubMoviListSize == 0) {
+        LOG_ERROR("Invalid ?MOVI chunk list");
+        return false;
+    }
+
+    uint64_t curFrameOffset = m_cursor.tell();
+
+    char fram[5] = { 0 };
+    m_cursor.read(fram, 4);
+
+    if (strcmp(fram, "FRAM") != 0) {
+        LOG_ERROR("Invalid FRAM header");
+        return false;
+    }
+
+    packet.frame = m_currentFrame;
+    while (!m_cursor.atEnd() && m_cursor.tell() < curFrameOffset + chunkSubMoviListSize) {
+        char chunkType[5] = { 0 };
+        m_cursor.read(chunkType, 4);
+
+        uint32_t chunkSize = 0;
+        chunkSize = readUint32();
+
+        if (strcmp(chunkType, "cfrm") == 0) {
+            FrameFragments* fragments = nullptr;
+            if (!readFragment(chunkSize, fragments)) {
+                break;
+            }
+
+            if (fragments != nullptr) {
+                // Reassembled frames are predicted frames without their first word, buffers are exchanged, not copied
+                Chunk& chunk = nextVideoChunk(packet);
+                chunk.type = CF_PFRM;
+                chunk.header = 0;
+                std::swap(chunk.buffer, fragments->data);
+                chunk.data = std::span<const uint8_t>(chunk.buffer).first(fragments->size);
+                fragments->size = 0;
             }
 
-            m_file.seekg(m_file.tellg() + (std::streampos)chunkSize);
+            continue;
+        }
+
+        bool isSound = strcmp(chunkType, "snd_") == 0;
+        bool isIntra = strcmp(chunkType, "ifrm") == 0;
+        if (!isSound && !isIntra && strcmp(chunkType, "pfrm") != 0) {
+            LOG_ERROR("Invalid ?FRM header");
+            return false;
+        }
+
+        if (chunkSize < 4) {
+            LOG_ERROR("Invalid {} chunk", chunkType);
+            m_cursor.skip(chunkSize);
+            continue;
+        }
+
+        if (isSound && !withSound) {
+            m_cursor.skip(chunkSize);
+            continue;
         }
 
-        ++m_frameCount;
+        Chunk& chunk = isSound ? packet.sound : nextVideoChunk(packet);
+        chunk.type = isSound ? CF_SOUND : (isIntra ? CF_IFRM : CF_PFRM);
+        chunk.header = readUint32();
+        chunk.data = m_cursor.view(chunkSize - 4); // Truncated at the end of the file
+    }
+
+    // Skip what is left of the frame after a chunk error
+    m_cursor.seek(curFrameOffset + chunkSubMoviListSize);
+    ++m_currentFrame;
+
+    return true;
+}
+
+/**
+ * Decodes the video chunks of a packet in order.
+ * @param dataVideo Receives the last decoded frame, may be null to only update the decoder state.
+ * @return False if the packet holds no video or on error.
+ */
+bool Fxm::Impl::decodeVideo(const Packet& packet, std::vector<uint16_t>* dataVideo)
+{
+    if (packet.videoCount == 0) {
+        return false;
+    }
+
+    if (m_videoTracks.empty()) {
+        LOG_ERROR("No video track found");
+        return false;
+    }
+
+    for (int i = 0; i < packet.videoCount; ++i) {
+        // ifrm first word is unused, pfrm first word holds stream sizes in version 1 files
+        const Chunk& chunk = packet.video[i];
+        bool decoded = chunk.type == CF_IFRM
+            ? m_decoder.decodeIntraFrame(chunk.data)
+            : m_decoder.decodePredictedFrame(chunk.data, chunk.header);
+        if (!decoded) {
+            LOG_ERROR("Invalid video chunk in frame {}", packet.frame);
+            return false;
+        }
+    }
+
+    if (dataVideo != nullptr) {
+        std::span<const uint16_t> frame = m_decoder.getFrame();
+        dataVideo->assign(frame.begin(), frame.end());
+    }
+
+    return true;
+}
+
+/**
+ * Size of the decoded sound of a packet in bytes.
+ * Layout after the first word (probably the track number): sound size, then raw data or ADPCM headers and data.
+ * @return 0 if the packet holds no sound.
+ */
+size_t Fxm::Impl::soundSize(const Packet& packet) const
+{
+    std::span<const uint8_t> data = packet.sound.data;
+    if (packet.sound.type != CF_SOUND) {
+        return 0;
+    }
+
+    if (data.size() < 4) {
+        LOG_ERROR("Empty sound data");
+        return 0;
+    }
+
+    if (m_soundTracks.empty()) {
+        LOG_ERROR("No sound track found");
+        return 0;
+    }
+
+    size_t size = readLe32(data, 0);
+    if (m_soundTracks[0].type == AudioType::AT_PCM) {
+        size = std::min(size, data.size() - 4);
     }
 
-    m_file.seekg(offsetMoviData);
+    return size;
+}
+
+/**
+ * Decodes the sound chunk of a packet to 16 bits PCM.
+ * @param dataAudio Output, exactly soundSize bytes.
+ */
+bool Fxm::Impl::decodeSound(const Packet& packet, std::span<uint8_t> dataAudio) const
+{
+    std::span<const uint8_t> data = packet.sound.data;
+    size_t soundSize = dataAudio.size();
+
+    const TrackSound& track = m_soundTracks[0];
+    switch (track.type) {
+    case AudioType::AT_PCM:
+        std::copy_n(data.begin() + 4, soundSize, dataAudio.begin());
+        break;
+    case AudioType::AT_4X_IMA_ADPCM: {
+        if (track.channels == 1) {
+            // Mono: predictor, step index, then 2 samples per byte
+            if (data.size() < 8 || (data.size() - 8) * 4 > soundSize) {
+                LOG_ERROR("Invalid ADPCM sound data");
+                return false;
+            }
+
+            ofnx::audio::ImaAdpcm::State state { int16_t(readLe16(data, 4)), int16_t(readLe16(data, 6)) };
+            if (!ofnx::audio::ImaAdpcm::decodeMono(data.subspan(8), dataAudio, state)) {
+                return false;
+            }
+        } else if (track.channels == 2) {
+            // Stereo: predictors and step indexes of both channels, then left and right data
+            size_t size = data.size() < 12 ? 0 : (data.size() - 12) / 2;
+            if (data.size() < 12 || size * 8 > soundSize) {
+                LOG_ERROR("Invalid ADPCM sound data");
+                return false;
+            }
+
+            ofnx::audio::ImaAdpcm::State left { int16_t(readLe16(data, 4)), readLe16(data, 8) };
+            ofnx::audio::ImaAdpcm::State right { int16_t(readLe16(data, 6)), readLe16(data, 10) };
+            if (!ofnx::audio::ImaAdpcm::decodeStereo(data.subspan(12, size), data.subspan(12 + size, size), dataAudio, left, right)) {
+                return false;
+            }
+        } else {
+            LOG_ERROR("Unsupported channel count: {}", track.channels);
+            return false;
+        }
+        break;
+    }
+    default:
+        LOG_ERROR("Invalid/unsupported audio type");
+        return false;
+    }
 
     return true;
 }
 
+/**
+ * Copies the last decoded frame to rows pitch pixels apart.
+ */
+void Fxm::Impl::copyFrame(std::span<uint16_t> output, int pitch) const
+{
+    std::span<const uint16_t> frame = m_decoder.getFrame();
+    int width = m_decoder.getWidth();
+    for (int y = 0; y < m_decoder.getHeight(); ++y) {
+        std::copy_n(frame.begin() + size_t(y) * width, width, output.begin() + size_t(y) * pitch);
+    }
+}
+
 /* PUBLIC */
 Fxm::Fxm()
 {
@@ -414,33 +958,56 @@ Fxm::Fxm()
 
 Fxm::~Fxm()
 {
+    d_ptr->stopIndexing();
     delete d_ptr;
 }
 
 bool Fxm::open(const std::string& videoName)
 {
-    d_ptr->m_file.open(videoName, std::ios::in | std::ios::binary);
-    if (!d_ptr->m_file.is_open()) {
+    close();
+
+    if (!d_ptr->m_file.open(videoName)) {
         return false;
     }
 
-    if (!d_ptr->readRiff()) {
+    if (d_ptr->m_file.map()) {
+        d_ptr->m_data = d_ptr->m_file.mappedData();
+    } else {
+        LOG_WARN("Unable to map {}, reading it in memory", videoName);
+
+        auto data = std::make_shared<std::vector<uint8_t>>(d_ptr->m_file.size());
+        if (!d_ptr->m_file.read(0, data->size(), data->data())) {
+            LOG_ERROR("Unable to read {}", videoName);
+            close();
+            return false;
+        }
+
         d_ptr->m_file.close();
-        return false;
+        d_ptr->m_sharedData = data;
+        d_ptr->m_data = *data;
     }
 
-    if (!d_ptr->readHead()) {
-        d_ptr->m_file.close();
+    if (!d_ptr->openData()) {
+        close();
         return false;
     }
 
-    if (!d_ptr->readTrk_()) {
-        d_ptr->m_file.close();
+    return true;
+}
+
+bool Fxm::open(std::shared_ptr<const std::vector<uint8_t>> data)
+{
+    close();
+
+    if (!data) {
         return false;
     }
 
-    if (!d_ptr->readMovi()) {
-        d_ptr->m_file.close();
+    d_ptr->m_sharedData = std::move(data);
+    d_ptr->m_data = *d_ptr->m_sharedData;
+
+    if (!d_ptr->openData()) {
+        close();
         return false;
     }
 
@@ -449,12 +1016,34 @@ bool Fxm::open(const std::string& videoName)
 
 void Fxm::close()
 {
+    d_ptr->stopIndexing();
+
+    // Packet and fragment data may point into the file
+    d_ptr->m_packet.videoCount = 0;
+    d_ptr->m_packet.sound.type = 0;
+    for (Impl::FrameFragments& fragments : d_ptr->m_fragments) {
+        fragments.size = 0;
+    }
+
+    {
+        std::lock_guard lock(d_ptr->m_indexMutex);
+        d_ptr->m_frameIndex.clear();
+        d_ptr->m_moviDataOffset = 0;
+        d_ptr->m_moviEnd = 0;
+    }
+    d_ptr->m_currentFrame = 0;
+    d_ptr->m_videoTracks.clear();
+    d_ptr->m_soundTracks.clear();
+
+    d_ptr->m_cursor.reset({});
+    d_ptr->m_data = {};
+    d_ptr->m_sharedData.reset();
     d_ptr->m_file.close();
 }
 
 bool Fxm::isOpen() const
 {
-    return d_ptr->m_file.is_open();
+    return !d_ptr->m_data.empty();
 }
 
 void Fxm::printInfo() const
@@ -464,12 +1053,13 @@ void Fxm::printInfo() const
     LOG_INFO("    Info: {}", d_ptr->m_info);
     LOG_INFO("    Data rate: {}", d_ptr->m_dataRate);
     LOG_INFO("    Frame rate: {} fps", d_ptr->m_frameRate);
-    LOG_INFO("    Frame count: {}", d_ptr->m_frameCount);
+    LOG_INFO("    Frame count: {}", d_ptr->frameCount());
     LOG_INFO("    Video tracks:");
     for (const auto& track : d_ptr->m_videoTracks) {
         LOG_INFO("        Name: {}", track.name);
         LOG_INFO("        Width: {}", track.width);
         LOG_INFO("        Height: {}", track.height);
+        LOG_INFO("        Version: {}", track.version);
     }
     LOG_INFO("    Sound tracks:");
     for (const auto& track : d_ptr->m_soundTracks) {
@@ -507,7 +1097,7 @@ int Fxm::getFrameRate() const
 
 int Fxm::getFrameCount() const
 {
-    return d_ptr->m_frameCount;
+    return d_ptr->frameCount();
 }
 
 bool Fxm::hasSound() const
@@ -520,212 +1110,132 @@ const Fxm::TrackSound& Fxm::getTrackSound() const
     return d_ptr->m_soundTracks[0];
 }
 
-void imaAdpcmUncompress(
-    uint8_t* input,
-    size_t size,
-    uint8_t* output,
-    int initialPredictor,
-    int initialIndex,
-    int skip = 0)
+bool Fxm::readFrame(std::vector<uint16_t>& dataVideo, std::vector<uint8_t>& dataAudio)
 {
-    int ima_index_table[16] = {
-        -1, -1, -1, -1, 2, 4, 6, 8,
-        -1, -1, -1, -1, 2, 4, 6, 8
-    };
-
-    int ima_step_table[89] = {
-        7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
-        19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
-        50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
-        130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
-        337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
-        876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
-        2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
-        5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
-        15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
-    };
-
-    // Decode the IMA data (bottom nibble first)
-    for (int i = 0; i < size; ++i) {
-        int8_t byte = *input++;
-
-        int8_t nibble1 = byte & 0x0F;
-        int8_t nibble2 = (byte & 0xF0) >> 4;
-
-        for (int i = 0; i < 2; ++i) {
-            int step = ima_step_table[initialIndex];
-            int stepIndex = initialIndex + ima_index_table[nibble1];
-            stepIndex = std::clamp(stepIndex, 0, 88);
-
-            int diff = ((2 * (nibble1 & 7) + 1) * step) >> 4;
-            int predictor = initialPredictor;
-            if (nibble1 & 8) {
-                predictor -= diff;
-            } else {
-                predictor += diff;
-            }
-
-            predictor = std::clamp(predictor, -32768, 32767);
-
-            initialPredictor = predictor;
-            initialIndex = stepIndex;
+    if (!d_ptr->readPacket(d_ptr->m_packet, true)) {
+        return false;
+    }
 
-            nibble1 = nibble2;
+    d_ptr->decodeVideo(d_ptr->m_packet, &dataVideo);
+    decodeSound(d_ptr->m_packet, dataAudio);
 
-            // Write the predictor to the output
-            *(output++) = (predictor & 0xFF);
-            *(output++) = ((predictor >> 8) & 0xFF);
-            output += skip;
-        }
-    }
+    return true;
 }
 
-bool Fxm::readFrame(std::vector<uint16_t>& dataVideo, std::vector<uint8_t>& dataAudio)
+bool Fxm::readFrame(FrameOutput& output)
 {
-    uint32_t chunkSubMoviListSize = d_ptr->readChunkList();
-    if (chunkSubMoviListSize == 0) {
-        LOG_ERROR("Invalid ?MOVI chunk list");
+    output.hasVideo = false;
+    output.audioSize = 0;
+
+    int width = getWidth();
+    int pitch = output.videoPitch == 0 ? width : output.videoPitch;
+    if (!output.video.empty() && (pitch < width || output.video.size() < size_t(getHeight() - 1) * pitch + width)) {
+        LOG_ERROR("Video output too small");
         return false;
     }
 
-    size_t curFrameOffset = d_ptr->m_file.tellg();
-
-    char fram[5] = { 0 };
-    d_ptr->m_file.read(fram, 4);
-
-    if (strcmp(fram, "FRAM") != 0) {
-        LOG_ERROR("Invalid FRAM header");
+    if (!d_ptr->readPacket(d_ptr->m_packet, !output.audio.empty())) {
         return false;
     }
 
-    while (d_ptr->m_file.tellg() < curFrameOffset + chunkSubMoviListSize) {
-        char chunkType[5] = { 0 };
-        d_ptr->m_file.read(chunkType, 4);
+    // Video is decoded even without output, predicted frames depend on it
+    output.hasVideo = d_ptr->decodeVideo(d_ptr->m_packet, nullptr);
+    if (output.hasVideo && !output.video.empty()) {
+        d_ptr->copyFrame(output.video, pitch);
+    }
 
-        uint32_t chunkSize = 0;
-        d_ptr->m_file >> chunkSize;
+    size_t soundSize = d_ptr->soundSize(d_ptr->m_packet);
+    if (soundSize > output.audio.size()) {
+        LOG_ERROR("Audio output too small: {} bytes needed", soundSize);
+    } else if (soundSize > 0 && d_ptr->decodeSound(d_ptr->m_packet, output.audio.first(soundSize))) {
+        output.audioSize = soundSize;
+    }
 
-        std::vector<uint8_t> chunkData(chunkSize);
-        d_ptr->m_file.read((char*)chunkData.data(), chunkSize);
+    return true;
+}
 
-        if (strcmp(chunkType, "ifrm") == 0) {
-            ofnx::tools::DataStream ds(&chunkData);
-            ds.setEndian(std::endian::little);
+bool Fxm::readPacket(Packet& packet)
+{
+    return d_ptr->readPacket(packet, true);
+}
 
-            uint32_t unkn1;
-            ds >> unkn1;
+bool Fxm::decodeVideo(const Packet& packet, std::vector<uint16_t>& dataVideo)
+{
+    return d_ptr->decodeVideo(packet, &dataVideo);
+}
 
-            uint32_t bitstreamSize;
-            ds >> bitstreamSize;
+bool Fxm::decodeSound(const Packet& packet, std::vector<uint8_t>& dataAudio) const
+{
+    size_t soundSize = d_ptr->soundSize(packet);
+    if (soundSize == 0) {
+        return false;
+    }
 
-            std::vector<uint8_t> bitstream(bitstreamSize);
-            ds.read(bitstreamSize, bitstream.data());
+    dataAudio.resize(soundSize);
 
-            uint32_t prefixStreamSize; // Size of the prefix stream divided by 4
-            ds >> prefixStreamSize;
+    return d_ptr->decodeSound(packet, dataAudio);
+}
 
-            uint32_t tokenCount;
-            ds >> tokenCount;
+bool Fxm::seekToFrame(int frame)
+{
+    if (!d_ptr->waitForFrame(frame)) {
+        LOG_ERROR("Frame out of range: {}", frame);
+        return false;
+    }
 
-            // Prefix stream
-            std::vector<uint8_t> prefixStream(prefixStreamSize * 4);
-            ds.read(prefixStreamSize * 4, prefixStream.data());
+    // Frames are decoded forward from the nearest keyframe, fragments of frames started earlier are dropped
+    FrameInfo target;
+    uint64_t keyframeOffset;
+    uint64_t targetEnd;
+    {
+        std::lock_guard lock(d_ptr->m_indexMutex);
+        target = d_ptr->m_frameIndex[frame];
+        keyframeOffset = d_ptr->m_frameIndex[target.keyframe].offset;
+        targetEnd = size_t(frame) + 1 < d_ptr->m_frameIndex.size() ? d_ptr->m_frameIndex[frame + 1].offset : d_ptr->m_moviEnd;
+    }
 
-            // TODO
-            if (d_ptr->m_videoTracks.empty()) {
-                LOG_ERROR("No video track found");
-                break;
-            }
-            dataVideo.assign(d_ptr->m_videoTracks[0].width * d_ptr->m_videoTracks[0].height, 0xFFFF);
-        } else if (strcmp(chunkType, "pfrm") == 0) {
-            // TODO
-        } else if (strcmp(chunkType, "cfrm") == 0) {
-            // TODO
-        } else if (strcmp(chunkType, "snd_") == 0) {
-            if (chunkData.size() < 8) {
-                LOG_ERROR("Empty sound data");
-                break;
-            }
+    for (Impl::FrameFragments& fragments : d_ptr->m_fragments) {
+        fragments.size = 0;
+    }
 
-            ofnx::tools::DataStream ds(&chunkData);
-            ds.setEndian(std::endian::little);
+    // Fault in the frames about to be decoded at once rather than page by page
+    d_ptr->m_file.advise(keyframeOffset, targetEnd - keyframeOffset, ofnx::tools::RandomAccessFile::Advice::WILL_NEED);
+    d_ptr->m_cursor.seek(keyframeOffset);
+    d_ptr->m_currentFrame = target.keyframe;
+    while (d_ptr->m_currentFrame < frame) {
+        if (!d_ptr->readPacket(d_ptr->m_packet, false)) {
+            return false;
+        }
+        d_ptr->decodeVideo(d_ptr->m_packet, nullptr);
+    }
 
-            uint32_t unkn; // Probably the track number (need to check)
-            ds >> unkn;
+    return true;
+}
 
-            uint32_t soundSize;
-            ds >> soundSize;
+bool Fxm::seekToTime(double seconds)
+{
+    int frame = int(std::max(seconds, 0.0) * d_ptr->m_frameRate);
+    if (!d_ptr->waitForFrame(frame)) {
+        // Past the end, show the last frame
+        frame = d_ptr->frameCount() - 1;
+    }
 
-            if (d_ptr->m_soundTracks.empty()) {
-                LOG_ERROR("No sound track found");
-                break;
-            }
+    return seekToFrame(frame);
+}
 
-            dataAudio.resize(soundSize);
-            switch (d_ptr->m_soundTracks[0].type) {
-            case AudioType::AT_PCM:
-                ds.read(soundSize, dataAudio.data());
-                break;
-            case AudioType::AT_4X_IMA_ADPCM: {
-                if (d_ptr->m_soundTracks[0].channels == 1) {
-                    // Mono
-                    int16_t initialPredictor;
-                    ds >> initialPredictor;
-
-                    int16_t initialIndex;
-                    ds >> initialIndex;
-
-                    imaAdpcmUncompress(
-                        chunkData.data() + 12,
-                        chunkData.size() - 12,
-                        dataAudio.data(),
-                        initialPredictor,
-                        initialIndex);
-                } else if (d_ptr->m_soundTracks[0].channels == 2) {
-                    // Stereo
-                    int16_t initialPredictorLeft;
-                    ds >> initialPredictorLeft;
-
-                    int16_t initialPredictorRight;
-                    ds >> initialPredictorRight;
-
-                    uint16_t initialIndexLeft;
-                    ds >> initialIndexLeft;
-
-                    uint16_t initialIndexRight;
-                    ds >> initialIndexRight;
-
-                    uint8_t* inputTmp = chunkData.data() + 16;
-                    int size = (chunkData.size() - 16) / 2;
-                    imaAdpcmUncompress(
-                        inputTmp,
-                        size,
-                        dataAudio.data(),
-                        initialPredictorLeft,
-                        initialIndexLeft,
-                        2);
-                    imaAdpcmUncompress(
-                        inputTmp + size,
-                        size,
-                        dataAudio.data() + 2,
-                        initialPredictorRight,
-                        initialIndexRight,
-                        2);
-                }
+int Fxm::getCurrentFrame() const
+{
+    return d_ptr->m_currentFrame;
+}
 
-                break;
-            }
-            default:
-                LOG_ERROR("Invalid/unsupported audio type");
-                break;
-            }
-        } else {
-            LOG_ERROR("Invalid ?FRM header");
-            return false;
-        }
+Fxm::FrameInfo Fxm::getFrameInfo(int frame) const
+{
+    if (!d_ptr->waitForFrame(frame)) {
+        return {};
     }
 
-    return true;
+    std::lock_guard lock(d_ptr->m_indexMutex);
+    return d_ptr->m_frameIndex[frame];
 }
 
 } // namespace ofnx::files
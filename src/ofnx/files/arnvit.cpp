@@ -24,27 +24,395 @@ SOFTWARE.
 
 #include "ofnx/files/arnvit.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <map>
+#include <thread>
+#include <unordered_map>
 
 #include "ofnx/tools/datastream.h"
 #include "ofnx/tools/log.h"
+#include "ofnx/tools/randomaccessfile.h"
+#include "ofnx/tools/simd.h"
 
 namespace ofnx::files {
 
 /* PRIVATE */
+struct NameHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view name) const
+    {
+        return std::hash<std::string_view> {}(name);
+    }
+};
+
+/*
+ * Row conversions from little endian RGB565 sprite pixels
+ */
+static void convertRowRgb555(const uint8_t* in, uint8_t* out, size_t count)
+{
+    size_t x = 0;
+#ifdef OFNX_SIMD_SSE2
+    const __m128i maskRg = _mm_set1_epi16(0x7FE0);
+    const __m128i maskB = _mm_set1_epi16(0x001F);
+    for (; x + 8 <= count; x += 8) {
+        __m128i pixel = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + x * 2));
+        __m128i rg = _mm_and_si128(_mm_srli_epi16(pixel, 1), maskRg);
+        __m128i b = _mm_and_si128(pixel, maskB);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 2), _mm_or_si128(rg, b));
+    }
+#endif
+
+    for (; x < count; ++x) {
+        uint16_t pixel = in[x * 2] | (in[x * 2 + 1] << 8);
+        pixel = ((pixel >> 1) & 0x7FE0) | (pixel & 0x001F);
+
+        out[x * 2] = pixel & 0xFF;
+        out[x * 2 + 1] = pixel >> 8;
+    }
+}
+
+static void convertRowBgra32(const uint8_t* in, uint8_t* out, size_t count)
+{
+    size_t x = 0;
+#ifdef OFNX_SIMD_SSE2
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i mask6 = _mm_set1_epi16(0x3F);
+    const __m128i alpha = _mm_set1_epi16(short(0xFF00));
+    for (; x + 8 <= count; x += 8) {
+        __m128i pixel = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + x * 2));
+
+        __m128i r = _mm_srli_epi16(pixel, 11);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(pixel, 5), mask6);
+        __m128i b = _mm_and_si128(pixel, mask5);
+
+        // Expand to 8 bits by replicating high bits into low bits
+        r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+        g = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+        b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+
+        __m128i bg = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+        __m128i ra = _mm_or_si128(r, alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm_unpacklo_epi16(bg, ra));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4 + 16), _mm_unpackhi_epi16(bg, ra));
+    }
+#endif
+
+    for (; x < count; ++x) {
+        uint16_t pixel = in[x * 2] | (in[x * 2 + 1] << 8);
+        uint8_t r = pixel >> 11;
+        uint8_t g = (pixel >> 5) & 0x3F;
+        uint8_t b = pixel & 0x1F;
+
+        out[x * 4] = (b << 3) | (b >> 2);
+        out[x * 4 + 1] = (g << 2) | (g >> 4);
+        out[x * 4 + 2] = (r << 3) | (r >> 2);
+        out[x * 4 + 3] = 0xFF;
+    }
+}
+
+static void convertRowRgb24(const uint8_t* in, uint8_t* out, size_t count, bool bgr)
+{
+    // Goes through the 32 bits conversion by small chunks kept in cache
+    uint8_t tmp[64 * 4];
+    for (size_t x = 0; x < count; x += 64) {
+        size_t chunk = std::min<size_t>(64, count - x);
+        convertRowBgra32(in + x * 2, tmp, chunk);
+
+        for (size_t i = 0; i < chunk; ++i) {
+            out[0] = tmp[i * 4 + (bgr ? 0 : 2)];
+            out[1] = tmp[i * 4 + 1];
+            out[2] = tmp[i * 4 + (bgr ? 2 : 0)];
+            out += 3;
+        }
+    }
+}
+
+static uint32_t crc32Png(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+    static const auto table = [] {
+        std::array<uint32_t, 256> table;
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                value = (value & 1) ? 0xEDB88320 ^ (value >> 1) : value >> 1;
+            }
+            table[i] = value;
+        }
+        return table;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+static uint32_t adler32Png(const uint8_t* data, size_t size, uint32_t adler = 1)
+{
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+    while (size > 0) {
+        // 5552 bytes can be summed before b overflows
+        size_t chunk = std::min<size_t>(size, 5552);
+        for (size_t i = 0; i < chunk; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+
+        data += chunk;
+        size -= chunk;
+    }
+
+    return (b << 16) | a;
+}
+
 class ArnVit::Impl {
     friend class ArnVit;
 
+public:
+    bool readPixels(int index, std::vector<uint8_t>& buffer, std::span<const uint8_t>& pixels) const;
+    bool writeImage(int index, const std::string& outputDirectory, ImageFormat format,
+        std::vector<uint8_t>& buffer, std::vector<uint8_t>& image) const;
+
+    static void encodeBmp(const ArnVitFile& file, const uint8_t* pixels, ImageFormat format, std::vector<uint8_t>& image);
+    static void encodePng(const ArnVitFile& file, const uint8_t* pixels, std::vector<uint8_t>& image);
+
 private:
     std::fstream fileVit;
-    std::fstream fileArn;
+    ofnx::tools::RandomAccessFile fileArn; // Positional reads, safe to share between threads
 
     std::vector<ArnVit::ArnVitFile> fileList;
-    std::map<std::string, int> fileNameMap;
+    std::unordered_map<std::string, int, NameHash, std::equal_to<>> fileNameMap;
 };
 
+bool ArnVit::Impl::readPixels(int index, std::vector<uint8_t>& buffer, std::span<const uint8_t>& pixels) const
+{
+    if (index < 0 || index >= fileList.size()) {
+        LOG_ERROR("Index out of range");
+        return false;
+    }
+
+    const ArnVitFile& file = fileList[index];
+    if (file.fileSize < file.width * file.height * 2) {
+        LOG_ERROR("Invalid sprite size: {}", file.fileName);
+        return false;
+    }
+
+    // Mapped files are used in place, otherwise read into the caller's scratch buffer
+    std::span<const uint8_t> arnData = fileArn.mappedData();
+    if (!arnData.empty()) {
+        if (uint64_t(file.offset) + file.fileSize > arnData.size()) {
+            LOG_ERROR("Unable to read ARN data: {}", file.fileName);
+            return false;
+        }
+
+        pixels = arnData.subspan(file.offset, file.fileSize);
+        return true;
+    }
+
+    buffer.resize(file.fileSize);
+    if (!fileArn.read(file.offset, file.fileSize, buffer.data())) {
+        LOG_ERROR("Unable to read ARN data: {}", file.fileName);
+        return false;
+    }
+
+    pixels = buffer;
+    return true;
+}
+
+bool ArnVit::Impl::writeImage(int index, const std::string& outputDirectory, ImageFormat format,
+    std::vector<uint8_t>& buffer, std::vector<uint8_t>& image) const
+{
+    std::span<const uint8_t> pixels;
+    if (!readPixels(index, buffer, pixels)) {
+        LOG_ERROR("Unable to read file data");
+        return false;
+    }
+
+    const ArnVitFile& file = fileList[index];
+
+    std::filesystem::path imagePath = outputDirectory + file.fileName;
+    if (format == ImageFormat::PNG_RGB24) {
+        imagePath.replace_extension(".png");
+        encodePng(file, pixels.data(), image);
+    } else {
+        encodeBmp(file, pixels.data(), format, image);
+    }
+
+    std::fstream fileImage(imagePath, std::ios::binary | std::ios::out);
+    if (!fileImage.is_open()) {
+        LOG_ERROR("Unable to open image file: {}", imagePath.string());
+        return false;
+    }
+
+    fileImage.write(reinterpret_cast<const char*>(image.data()), image.size());
+    if (!fileImage.good()) {
+        LOG_ERROR("Unable to write image file: {}", imagePath.string());
+        return false;
+    }
+
+    return true;
+}
+
+void ArnVit::Impl::encodeBmp(const ArnVitFile& file, const uint8_t* pixels, ImageFormat format, std::vector<uint8_t>& image)
+{
+    int bitsPerPixel;
+    switch (format) {
+    case ImageFormat::BMP_RGB24:
+        bitsPerPixel = 24;
+        break;
+    case ImageFormat::BMP_ARGB32:
+        bitsPerPixel = 32;
+        break;
+    case ImageFormat::BMP_RGB555:
+    default:
+        bitsPerPixel = 16;
+        break;
+    }
+
+    size_t rowSize = file.width * (bitsPerPixel / 8);
+    size_t rowStride = (rowSize + 3) & ~size_t(3);
+    size_t fileSize = 54 + rowStride * file.height;
+
+    image.clear();
+    ofnx::tools::DataStream ds(&image);
+    ds.setEndian(std::endian::little);
+
+    // BMP header
+    ds << uint16_t(0x4D42); // BM
+    ds << uint32_t(fileSize); // File size
+    ds << uint16_t(0); // Reserved
+    ds << uint16_t(0); // Reserved
+    ds << uint32_t(54); // Offset to image data
+
+    // DIB header
+    ds << uint32_t(40); // DIB header size
+    ds << uint32_t(file.width); // Width
+    ds << uint32_t(-file.height); // Height
+    ds << uint16_t(1); // Planes
+    ds << uint16_t(bitsPerPixel); // Bits per pixel
+    ds << uint32_t(0); // Compression
+    ds << uint32_t(0); // Image size (ignored for uncompressed images)
+    ds << uint32_t(0); // X pixels per meter
+    ds << uint32_t(0); // Y pixels per meter
+    ds << uint32_t(0); // Colors in color table
+    ds << uint32_t(0); // Important color count
+
+    // Image data, converted row by row straight into the output buffer
+    image.resize(fileSize, 0x00);
+    for (uint32_t y = 0; y < file.height; y++) {
+        const uint8_t* rowIn = pixels + y * file.width * 2;
+        uint8_t* rowOut = image.data() + 54 + y * rowStride;
+
+        switch (bitsPerPixel) {
+        case 24:
+            convertRowRgb24(rowIn, rowOut, file.width, true);
+            break;
+        case 32:
+            convertRowBgra32(rowIn, rowOut, file.width);
+            break;
+        default:
+            convertRowRgb555(rowIn, rowOut, file.width);
+
+            if (rowStride != rowSize) {
+                rowOut[rowSize + 1] = 0xFF;
+            }
+            break;
+        }
+    }
+}
+
+void ArnVit::Impl::encodePng(const ArnVitFile& file, const uint8_t* pixels, std::vector<uint8_t>& image)
+{
+    // Filtered scanlines (filter type 0), stored in uncompressed deflate blocks
+    size_t rowSize = 1 + file.width * 3;
+    size_t rawSize = rowSize * file.height;
+    size_t blockCount = std::max<size_t>(1, (rawSize + 0xFFFE) / 0xFFFF);
+    size_t idatSize = 2 + rawSize + blockCount * 5 + 4;
+
+    image.clear();
+    image.reserve(8 + 25 + 12 + idatSize + 12);
+
+    auto append32 = [&](uint32_t value) {
+        image.push_back(value >> 24);
+        image.push_back(value >> 16);
+        image.push_back(value >> 8);
+        image.push_back(value);
+    };
+
+    auto appendChunkEnd = [&](size_t chunkStart) {
+        append32(crc32Png(image.data() + chunkStart, image.size() - chunkStart));
+    };
+
+    const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    image.insert(image.end(), signature, signature + 8);
+
+    // IHDR
+    append32(13);
+    size_t chunkStart = image.size();
+    image.insert(image.end(), { 'I', 'H', 'D', 'R' });
+    append32(file.width);
+    append32(file.height);
+    image.insert(image.end(), { 8, 2, 0, 0, 0 }); // 8 bits RGB, no interlace
+    appendChunkEnd(chunkStart);
+
+    // IDAT
+    append32(idatSize);
+    chunkStart = image.size();
+    image.insert(image.end(), { 'I', 'D', 'A', 'T' });
+    image.insert(image.end(), { 0x78, 0x01 }); // zlib header
+
+    size_t rawStart = image.size() + 5;
+    size_t rawOffset = 0;
+    for (size_t block = 0; block < blockCount; ++block) {
+        uint16_t blockSize = std::min<size_t>(0xFFFF, rawSize - rawOffset);
+        image.push_back(block + 1 == blockCount ? 1 : 0);
+        image.push_back(blockSize & 0xFF);
+        image.push_back(blockSize >> 8);
+        image.push_back(~blockSize & 0xFF);
+        image.push_back(~blockSize >> 8);
+        image.resize(image.size() + blockSize);
+        rawOffset += blockSize;
+    }
+
+    // Scanlines are written across block boundaries through a temporary row
+    std::vector<uint8_t> row(rowSize);
+    uint32_t adler = 1;
+    size_t rawWritten = 0;
+    for (uint32_t y = 0; y < file.height; y++) {
+        row[0] = 0;
+        convertRowRgb24(pixels + y * file.width * 2, row.data() + 1, file.width, false);
+        adler = adler32Png(row.data(), rowSize, adler);
+
+        for (size_t i = 0; i < rowSize;) {
+            size_t blockIndex = rawWritten / 0xFFFF;
+            size_t blockOffset = rawWritten % 0xFFFF;
+            size_t count = std::min(rowSize - i, size_t(0xFFFF) - blockOffset);
+            std::memcpy(image.data() + rawStart + blockIndex * (0xFFFF + 5) + blockOffset, row.data() + i, count);
+            i += count;
+            rawWritten += count;
+        }
+    }
+    append32(adler);
+    appendChunkEnd(chunkStart);
+
+    // IEND
+    append32(0);
+    chunkStart = image.size();
+    image.insert(image.end(), { 'I', 'E', 'N', 'D' });
+    appendChunkEnd(chunkStart);
+}
+
 /* PUBLIC */
 ArnVit::ArnVit()
 {
@@ -56,7 +424,7 @@ ArnVit::~ArnVit()
     delete d_ptr;
 }
 
-bool ArnVit::open(const std::string& vitFileName, const std::string& arnFileName)
+bool ArnVit::open(const std::string& vitFileName, const std::string& arnFileName, AccessMode mode)
 {
     d_ptr->fileVit.open(vitFileName, std::ios::binary | std::ios::in);
     if (!d_ptr->fileVit.is_open()) {
@@ -64,13 +432,18 @@ bool ArnVit::open(const std::string& vitFileName, const std::string& arnFileName
         return false;
     }
 
-    d_ptr->fileArn.open(arnFileName, std::ios::binary | std::ios::in);
-    if (!d_ptr->fileArn.is_open()) {
+    if (!d_ptr->fileArn.open(arnFileName)) {
         LOG_ERROR("Unable to open ARN file ", arnFileName);
         return false;
     }
 
+    if (mode == AccessMode::MAP && !d_ptr->fileArn.map()) {
+        LOG_ERROR("Unable to map ARN file ", arnFileName);
+        return false;
+    }
+
     d_ptr->fileList.clear();
+    d_ptr->fileNameMap.clear();
 
     // Parse VIT header file
     ofnx::tools::DataStream ds(&d_ptr->fileVit);
@@ -118,7 +491,7 @@ void ArnVit::close()
 
 bool ArnVit::isOpen() const
 {
-    return d_ptr->fileVit.is_open() && d_ptr->fileArn.is_open();
+    return d_ptr->fileVit.is_open() && d_ptr->fileArn.isOpen();
 }
 
 int ArnVit::fileCount() const
@@ -126,13 +499,25 @@ int ArnVit::fileCount() const
     return d_ptr->fileList.size();
 }
 
+int ArnVit::indexOf(std::string_view name) const
+{
+    auto it = d_ptr->fileNameMap.find(name);
+    if (it == d_ptr->fileNameMap.end()) {
+        return -1;
+    }
+
+    return it->second;
+}
+
 ArnVit::ArnVitFile ArnVit::getFile(const int index) const
 {
     ArnVitFile file = d_ptr->fileList[index];
 
-    d_ptr->fileArn.seekg(file.offset);
     file.data.resize(file.fileSize);
-    d_ptr->fileArn.read((char*)file.data.data(), file.fileSize);
+    if (!d_ptr->fileArn.read(file.offset, file.fileSize, file.data.data())) {
+        LOG_ERROR("Unable to read ARN data: {}", file.fileName);
+        file.data.clear();
+    }
 
     return file;
 }
@@ -147,77 +532,91 @@ ArnVit::ArnVitFile ArnVit::getFile(const std::string& name) const
     return getFile(it->second);
 }
 
-bool ArnVit::writeToBmp(const int index, const std::string& outputDirectory) const
+ArnVit::ArnVitView ArnVit::getView(const int index) const
 {
-    ArnVitFile file = getFile(index);
-    if (file.data.empty()) {
-        LOG_ERROR("Unable to read file data");
-        return false;
+    if (index < 0 || index >= d_ptr->fileList.size()) {
+        LOG_ERROR("Index out of range");
+        return {};
     }
 
-    std::string bmpFile = outputDirectory + file.fileName;
-    std::fstream fileBmp(bmpFile, std::ios::binary | std::ios::out);
-    if (!fileBmp.is_open()) {
-        LOG_ERROR("Unable to open BMP file: {}", bmpFile);
-        return false;
+    std::span<const uint8_t> arnData = d_ptr->fileArn.mappedData();
+    if (arnData.empty()) {
+        LOG_ERROR("ARN file not mapped");
+        return {};
     }
 
-    ofnx::tools::DataStream ds(&fileBmp);
-    ds.setEndian(std::endian::little);
+    const ArnVitFile& file = d_ptr->fileList[index];
+    if (uint64_t(file.offset) + file.fileSize > arnData.size()) {
+        LOG_ERROR("Unable to read ARN data: {}", file.fileName);
+        return {};
+    }
 
-    // BMP header
-    ds << uint16_t(0x4D42); // BM
-    ds << uint32_t(0); // File size (will be updated later)
-    ds << uint16_t(0); // Reserved
-    ds << uint16_t(0); // Reserved
-    ds << uint32_t(54); // Offset to image data
+    ArnVitView view;
+    view.fileName = file.fileName;
+    view.width = file.width;
+    view.height = file.height;
+    view.data = arnData.subspan(file.offset, file.fileSize);
 
-    // DIB header
-    ds << uint32_t(40); // DIB header size
-    ds << uint32_t(file.width); // Width
-    ds << uint32_t(-file.height); // Height
-    ds << uint16_t(1); // Planes
-    ds << uint16_t(16); // Bits per pixel
-    ds << uint32_t(0); // Compression
-    ds << uint32_t(0); // Image size (ignored for uncompressed images)
-    ds << uint32_t(0); // X pixels per meter
-    ds << uint32_t(0); // Y pixels per meter
-    ds << uint32_t(0); // Colors in color table
-    ds << uint32_t(0); // Important color count
+    return view;
+}
+
+ArnVit::ArnVitView ArnVit::getView(std::string_view name) const
+{
+    int index = indexOf(name);
+    if (index < 0) {
+        return {};
+    }
 
-    size_t fileSize = 54;
+    return getView(index);
+}
 
-    // Image data
-    bool addPadding = (file.width * 2) % 4 != 0;
-    for (uint32_t y = 0; y < file.height; y++) {
-        // fileBmp.write(data.data() + y * file.width * 2, file.width * 2);
-        for (uint32_t x = 0; x < file.width; x++) {
-            int idx = (y * file.width + x) * 2;
-            uint16_t pixel = (file.data[idx + 1] << 8) | file.data[idx];
+bool ArnVit::writeToBmp(const int index, const std::string& outputDirectory) const
+{
+    return writeImage(index, outputDirectory, ImageFormat::BMP_RGB555);
+}
 
-            // RGB565 to RGB555
-            pixel = ((pixel & 0b1111'1000'0000'0000) >> 1 | (pixel & 0b0000'0111'1100'0000) >> 1 | (pixel & 0b0000'0000'0001'1111));
+bool ArnVit::writeImage(const int index, const std::string& outputDirectory, ImageFormat format) const
+{
+    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> image;
+    return d_ptr->writeImage(index, outputDirectory, format, buffer, image);
+}
 
-            ds << pixel;
+bool ArnVit::exportAll(const std::string& outputDirectory, ImageFormat format, int threadCount) const
+{
+    int count = fileCount();
+    if (threadCount <= 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = std::max(1, std::min(threadCount, count));
 
-            fileSize += 2;
-        }
+    std::atomic<int> nextIndex = 0;
+    std::atomic<bool> success = true;
 
-        if (addPadding) {
-            ds << uint8_t(0x00);
-            ds << uint8_t(0xFF);
+    // Each worker keeps its scratch buffers for the whole batch
+    auto worker = [&]() {
+        std::vector<uint8_t> buffer;
+        std::vector<uint8_t> image;
 
-            fileSize += 2;
+        int index;
+        while ((index = nextIndex.fetch_add(1)) < count) {
+            if (!d_ptr->writeImage(index, outputDirectory, format, buffer, image)) {
+                success = false;
+            }
         }
-    }
+    };
 
-    // Write file size
-    fileBmp.seekp(2);
-    ds << uint32_t(fileSize);
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
 
-    fileBmp.close();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
 
-    return true;
+    return success;
 }
 
 } // namespace ofnx::files
@@ -0,0 +1,387 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "ofnx/files/fxmplayer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "ofnx/tools/log.h"
+
+namespace ofnx::files {
+
+#define FXM_PLAYER_DEFAULT_LOOKAHEAD 8
+
+/* Helper functions */
+/*
+ * Fixed size single producer / single consumer ring, slots are reused so their buffers keep their capacity
+ */
+template <typename T>
+class FxmRing {
+public:
+    // Only while no thread uses the ring
+    void reset(size_t capacity)
+    {
+        m_slots.resize(capacity);
+        m_head = 0;
+        m_tail = 0;
+    }
+
+    // Producer side, null if the ring is full
+    T* writeSlot()
+    {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= m_slots.size()) {
+            return nullptr;
+        }
+
+        return &m_slots[head % m_slots.size()];
+    }
+
+    void push()
+    {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer side, null if the ring is empty
+    T* readSlot()
+    {
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        if (m_head.load(std::memory_order_acquire) == tail) {
+            return nullptr;
+        }
+
+        return &m_slots[tail % m_slots.size()];
+    }
+
+    const T* readSlot() const
+    {
+        return const_cast<FxmRing*>(this)->readSlot();
+    }
+
+    void pop()
+    {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool empty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<T> m_slots;
+    alignas(64) std::atomic<uint64_t> m_head = 0; // Written by the producer
+    alignas(64) std::atomic<uint64_t> m_tail = 0; // Written by the consumer
+};
+
+/* PRIVATE */
+class FxmPlayer::Impl {
+    friend class FxmPlayer;
+
+public:
+    void signal();
+    void stop();
+
+    void demuxLoop();
+    void videoLoop();
+    void soundLoop();
+
+private:
+    Fxm m_fxm;
+    size_t m_lookahead;
+    bool m_soundEnabled = true;
+    bool m_hasSound = false; // Sound stage running
+
+    FxmRing<Fxm::Packet> m_videoPackets;
+    FxmRing<Fxm::Packet> m_soundPackets;
+    FxmRing<VideoFrame> m_videoFrames;
+    FxmRing<SoundBlock> m_soundBlocks;
+
+    std::thread m_demuxThread;
+    std::thread m_videoThread;
+    std::thread m_soundThread;
+
+    // Bumped on every ring change, threads sleep on it when they cannot progress
+    std::atomic<uint32_t> m_events = 0;
+    std::atomic_bool m_stop = false;
+    std::atomic_bool m_demuxDone = true;
+    std::atomic_bool m_videoDone = true;
+    std::atomic_bool m_soundDone = true;
+};
+
+void FxmPlayer::Impl::signal()
+{
+    m_events.fetch_add(1, std::memory_order_release);
+    m_events.notify_all();
+}
+
+void FxmPlayer::Impl::stop()
+{
+    m_stop = true;
+    signal();
+
+    for (std::thread* thread : { &m_demuxThread, &m_videoThread, &m_soundThread }) {
+        if (thread->joinable()) {
+            thread->join();
+        }
+    }
+}
+
+/**
+ * Reads packets into the video ring, sound chunks are moved to the sound ring by swapping buffers.
+ * A sound slot is only waited for by packets holding sound.
+ */
+void FxmPlayer::Impl::demuxLoop()
+{
+    bool pending = false; // Packet read into the video slot, waiting for a sound slot
+
+    while (!m_stop) {
+        uint32_t events = m_events.load(std::memory_order_acquire);
+
+        Fxm::Packet* videoPacket = m_videoPackets.writeSlot();
+        if (videoPacket == nullptr) {
+            m_events.wait(events, std::memory_order_acquire);
+            continue;
+        }
+
+        if (!pending) {
+            if (!m_fxm.readPacket(*videoPacket)) {
+                break;
+            }
+            pending = true;
+        }
+
+        if (m_hasSound && videoPacket->sound.type != 0) {
+            Fxm::Packet* soundPacket = m_soundPackets.writeSlot();
+            if (soundPacket == nullptr) {
+                m_events.wait(events, std::memory_order_acquire);
+                continue;
+            }
+
+            soundPacket->frame = videoPacket->frame;
+            std::swap(soundPacket->sound, videoPacket->sound);
+            m_soundPackets.push();
+        }
+        pending = false;
+
+        if (videoPacket->videoCount > 0) {
+            m_videoPackets.push();
+        }
+
+        signal();
+    }
+
+    m_demuxDone = true;
+    signal();
+}
+
+void FxmPlayer::Impl::videoLoop()
+{
+    while (!m_stop) {
+        uint32_t events = m_events.load(std::memory_order_acquire);
+
+        Fxm::Packet* packet = m_videoPackets.readSlot();
+        if (packet == nullptr && m_demuxDone && m_videoPackets.empty()) {
+            break;
+        }
+
+        VideoFrame* frame = m_videoFrames.writeSlot();
+        if (packet == nullptr || frame == nullptr) {
+            m_events.wait(events, std::memory_order_acquire);
+            continue;
+        }
+
+        if (m_fxm.decodeVideo(*packet, frame->pixels)) {
+            frame->frame = packet->frame;
+            m_videoFrames.push();
+        }
+
+        m_videoPackets.pop();
+        signal();
+    }
+
+    m_videoDone = true;
+    signal();
+}
+
+void FxmPlayer::Impl::soundLoop()
+{
+    while (!m_stop) {
+        uint32_t events = m_events.load(std::memory_order_acquire);
+
+        Fxm::Packet* packet = m_soundPackets.readSlot();
+        if (packet == nullptr && m_demuxDone && m_soundPackets.empty()) {
+            break;
+        }
+
+        SoundBlock* block = m_soundBlocks.writeSlot();
+        if (packet == nullptr || block == nullptr) {
+            m_events.wait(events, std::memory_order_acquire);
+            continue;
+        }
+
+        if (m_fxm.decodeSound(*packet, block->samples)) {
+            block->frame = packet->frame;
+            m_soundBlocks.push();
+        }
+
+        m_soundPackets.pop();
+        signal();
+    }
+
+    m_soundDone = true;
+    signal();
+}
+
+/* PUBLIC */
+FxmPlayer::FxmPlayer(int lookahead)
+{
+    d_ptr = new Impl;
+    d_ptr->m_lookahead = lookahead > 0 ? lookahead : FXM_PLAYER_DEFAULT_LOOKAHEAD;
+}
+
+FxmPlayer::~FxmPlayer()
+{
+    close();
+    delete d_ptr;
+}
+
+bool FxmPlayer::open(const std::string& videoName)
+{
+    close();
+
+    if (!d_ptr->m_fxm.open(videoName)) {
+        LOG_ERROR("Failed to open video: {}", videoName);
+        return false;
+    }
+
+    d_ptr->m_hasSound = d_ptr->m_soundEnabled && d_ptr->m_fxm.hasSound();
+    d_ptr->m_videoPackets.reset(d_ptr->m_lookahead);
+    d_ptr->m_soundPackets.reset(d_ptr->m_lookahead);
+    d_ptr->m_videoFrames.reset(d_ptr->m_lookahead);
+    d_ptr->m_soundBlocks.reset(d_ptr->m_lookahead);
+
+    d_ptr->m_stop = false;
+    d_ptr->m_demuxDone = false;
+    d_ptr->m_videoDone = false;
+    d_ptr->m_soundDone = !d_ptr->m_hasSound;
+
+    d_ptr->m_demuxThread = std::thread(&Impl::demuxLoop, d_ptr);
+    d_ptr->m_videoThread = std::thread(&Impl::videoLoop, d_ptr);
+    if (d_ptr->m_hasSound) {
+        d_ptr->m_soundThread = std::thread(&Impl::soundLoop, d_ptr);
+    }
+
+    return true;
+}
+
+void FxmPlayer::close()
+{
+    d_ptr->stop();
+    d_ptr->m_fxm.close();
+
+    d_ptr->m_demuxDone = true;
+    d_ptr->m_videoDone = true;
+    d_ptr->m_soundDone = true;
+}
+
+void FxmPlayer::setSoundEnabled(bool enabled)
+{
+    d_ptr->m_soundEnabled = enabled;
+}
+
+bool FxmPlayer::isSoundEnabled() const
+{
+    return d_ptr->m_soundEnabled;
+}
+
+bool FxmPlayer::isOpen() const
+{
+    return d_ptr->m_fxm.isOpen();
+}
+
+int FxmPlayer::getWidth() const
+{
+    return d_ptr->m_fxm.getWidth();
+}
+
+int FxmPlayer::getHeight() const
+{
+    return d_ptr->m_fxm.getHeight();
+}
+
+int FxmPlayer::getFrameRate() const
+{
+    return d_ptr->m_fxm.getFrameRate();
+}
+
+bool FxmPlayer::hasSound() const
+{
+    return d_ptr->m_hasSound;
+}
+
+const Fxm::TrackSound& FxmPlayer::getTrackSound() const
+{
+    return d_ptr->m_fxm.getTrackSound();
+}
+
+const FxmPlayer::VideoFrame* FxmPlayer::peekVideoFrame() const
+{
+    return d_ptr->m_videoFrames.readSlot();
+}
+
+void FxmPlayer::popVideoFrame()
+{
+    if (d_ptr->m_videoFrames.readSlot() == nullptr) {
+        return;
+    }
+
+    d_ptr->m_videoFrames.pop();
+    d_ptr->signal();
+}
+
+const FxmPlayer::SoundBlock* FxmPlayer::peekSoundBlock() const
+{
+    return d_ptr->m_soundBlocks.readSlot();
+}
+
+void FxmPlayer::popSoundBlock()
+{
+    if (d_ptr->m_soundBlocks.readSlot() == nullptr) {
+        return;
+    }
+
+    d_ptr->m_soundBlocks.pop();
+    d_ptr->signal();
+}
+
+bool FxmPlayer::isFinished() const
+{
+    return d_ptr->m_demuxDone && d_ptr->m_videoDone && d_ptr->m_soundDone
+        && d_ptr->m_videoFrames.empty() && d_ptr->m_soundBlocks.empty();
+}
+
+} // namespace ofnx::files
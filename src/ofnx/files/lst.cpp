@@ -25,106 +25,353 @@ SOFTWARE.
 #include "ofnx/files/lst.h"
 
 #include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <set>
+#include <span>
+#include <string_view>
+#include <unordered_map>
 
+#include "ofnx/tools/datastream.h"
 #include "ofnx/tools/log.h"
+#include "ofnx/tools/randomaccessfile.h"
 
 namespace ofnx::files {
 
+#define LST_CACHE_MAGIC 0x54534C4F // OLST
+#define LST_CACHE_VERSION 2
+#define LST_CACHE_NONE 0xFFFFFFFF
+
+#define LST_MAX_TEST_ID 0xFFFF // Test blocks are stored in a flat vector
+#define LST_MAX_NESTING 64 // ifand/ifor nested in each other
+// Instruction levels below a cached root: subroutine label, ifand/ifor chain, plugin block, plugin instructions
+#define LST_CACHE_MAX_DEPTH (LST_MAX_NESTING + 3)
+
+#define LST_HASH_SEED 14695981039346656037ull // FNV-1a 64 bits
+#define LST_HASH_PRIME 1099511628211ull
+
+/*
+ * Binary cache layout (little endian 32 bits words unless stated otherwise)
+ * Strings are interned, nodes reference each other by index:
+ *  - header (LstCacheField::COUNT words)
+ *  - string index (offset, size) in string data
+ *  - variables (string id)
+ *  - nodes (name string id, first param, param count, first child node, child count)
+ *  - params (string id)
+ *  - warps in id order (name string id, first init node, init node count, first test, test count)
+ *  - tests (test id, first node, node count)
+ *  - string data (raw bytes)
+ * Subroutines are stored as nodes (label name, instructions as children)
+ */
+enum LstCacheField {
+    LST_CACHE_FIELD_MAGIC,
+    LST_CACHE_FIELD_VERSION,
+    LST_CACHE_FIELD_SOURCE_SIZE_LOW,
+    LST_CACHE_FIELD_SOURCE_SIZE_HIGH,
+    LST_CACHE_FIELD_STRING_COUNT,
+    LST_CACHE_FIELD_STRING_INDEX_OFFSET,
+    LST_CACHE_FIELD_STRING_DATA_OFFSET,
+    LST_CACHE_FIELD_STRING_DATA_SIZE,
+    LST_CACHE_FIELD_VARIABLE_COUNT,
+    LST_CACHE_FIELD_VARIABLES_OFFSET,
+    LST_CACHE_FIELD_NODE_COUNT,
+    LST_CACHE_FIELD_NODES_OFFSET,
+    LST_CACHE_FIELD_PARAM_COUNT,
+    LST_CACHE_FIELD_PARAMS_OFFSET,
+    LST_CACHE_FIELD_WARP_COUNT,
+    LST_CACHE_FIELD_WARPS_OFFSET,
+    LST_CACHE_FIELD_TEST_COUNT,
+    LST_CACHE_FIELD_TESTS_OFFSET,
+    LST_CACHE_FIELD_SUBROUTINE_FIRST,
+    LST_CACHE_FIELD_SUBROUTINE_COUNT,
+    LST_CACHE_FIELD_INIT_WARP,
+    LST_CACHE_FIELD_COUNT,
+};
+
+constexpr uint32_t LST_CACHE_NODE_WORDS = 5;
+constexpr uint32_t LST_CACHE_WARP_WORDS = 5;
+constexpr uint32_t LST_CACHE_TEST_WORDS = 3;
+
 /* Helper functions */
-inline void trim(std::string& s)
+constexpr bool isSpace(char c)
 {
-    s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) { return !std::isspace(ch); }));
-    s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char ch) { return !std::isspace(ch); })
-                .base(),
-        s.end());
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
 }
 
-std::vector<std::string> split(const std::string& s, char delimiter)
+constexpr std::string_view trim(std::string_view s)
 {
-    std::vector<std::string> tokens;
-    std::string token;
-    std::istringstream tokenStream(s);
-    while (std::getline(tokenStream, token, delimiter)) {
-        trim(token);
+    while (!s.empty() && isSpace(s.front())) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && isSpace(s.back())) {
+        s.remove_suffix(1);
+    }
+
+    return s;
+}
+
+/*
+ * Calls fun on each trimmed token, following std::getline semantics
+ * (no token for an empty string or after a trailing delimiter)
+ */
+template <typename Fun>
+void split(std::string_view s, char delimiter, Fun&& fun)
+{
+    size_t position = 0;
+    while (position < s.size()) {
+        size_t end = s.find(delimiter, position);
+        if (end == std::string_view::npos) {
+            fun(trim(s.substr(position)));
+            break;
+        }
 
-        tokens.push_back(token);
+        fun(trim(s.substr(position, end - position)));
+        position = end + 1;
     }
+}
+
+std::vector<std::string> split(std::string_view s, char delimiter)
+{
+    std::vector<std::string> tokens;
+    split(s, delimiter, [&](std::string_view token) { tokens.emplace_back(token); });
     return tokens;
 }
 
+constexpr uint64_t hashBytes(uint64_t hash, std::string_view data)
+{
+    for (char c : data) {
+        hash = (hash ^ uint8_t(c)) * LST_HASH_PRIME;
+    }
+
+    return hash;
+}
+
+/*
+ * Instruction table, looked up through a perfect hash computed at compile time
+ */
+struct Opcode {
+    std::string_view name;
+    char separator = ',';
+};
+
+constexpr std::array OPCODES {
+    Opcode { "ifand" },
+    Opcode { "ifor" },
+    Opcode { "gotowarp" },
+    Opcode { "set", '=' },
+    Opcode { "playmusique" },
+    Opcode { "stopmusique" },
+    Opcode { "playsound" },
+    Opcode { "stopsound" },
+    Opcode { "playsound3d" },
+    Opcode { "stopsound3d" },
+    Opcode { "setcursor" },
+    Opcode { "setcursordefault" },
+    Opcode { "hidecursor" },
+    Opcode { "setangle" },
+    Opcode { "interpolangle" },
+    Opcode { "anglexmax" },
+    Opcode { "angleymax" },
+    Opcode { "return" },
+    Opcode { "end" },
+    Opcode { "fade" },
+    Opcode { "lockkey" }, // Second argument is either a string or a number (0)
+    Opcode { "resetlockkey" },
+    Opcode { "setzoom" },
+    Opcode { "gosub" },
+    Opcode { "not" },
+};
+
+constexpr size_t OPCODE_TABLE_SIZE = 64;
+
+constexpr uint32_t opcodeHash(std::string_view name, uint32_t seed)
+{
+    uint32_t hash = 2166136261u ^ seed;
+    for (char c : name) {
+        hash = (hash ^ uint8_t(c)) * 16777619u;
+    }
+
+    // Fold high bits in, FNV low bits only depend on low input bits
+    return (hash ^ (hash >> 16)) % OPCODE_TABLE_SIZE;
+}
+
+constexpr uint32_t findOpcodeSeed()
+{
+    for (uint32_t seed = 0;; ++seed) {
+        std::array<bool, OPCODE_TABLE_SIZE> used {};
+        bool collision = false;
+        for (const Opcode& opcode : OPCODES) {
+            uint32_t slot = opcodeHash(opcode.name, seed);
+            collision |= used[slot];
+            used[slot] = true;
+        }
+
+        if (!collision) {
+            return seed;
+        }
+    }
+}
+
+constexpr uint32_t OPCODE_SEED = findOpcodeSeed();
+
+constexpr std::array<int8_t, OPCODE_TABLE_SIZE> OPCODE_TABLE = [] {
+    std::array<int8_t, OPCODE_TABLE_SIZE> table {};
+    table.fill(-1);
+    for (size_t i = 0; i < OPCODES.size(); ++i) {
+        table[opcodeHash(OPCODES[i].name, OPCODE_SEED)] = i;
+    }
+    return table;
+}();
+
+constexpr const Opcode* findOpcode(std::string_view name)
+{
+    int8_t index = OPCODE_TABLE[opcodeHash(name, OPCODE_SEED)];
+    if (index < 0 || OPCODES[index].name != name) {
+        return nullptr;
+    }
+
+    return &OPCODES[index];
+}
+
+static_assert(findOpcode("set")->separator == '=');
+static_assert(findOpcode("label") == nullptr);
+
 /* PRIVATE */
 struct Warp {
     std::string name;
     Lst::InstructionBlock initBlock;
-    std::map<uint32_t, Lst::InstructionBlock> testBlockList;
+    std::vector<Lst::InstructionBlock> testBlockList; // Indexed by test id
+    std::vector<uint8_t> testPresent; // Test ids found in the script
+
+    bool hasTest(int testId) const
+    {
+        return testId >= 0 && testId < testPresent.size() && testPresent[testId];
+    }
+};
+
+/*
+ * Top level script range parsed on its own: part of a [warp] section (cut by labels) or a subroutine
+ */
+struct LstSection {
+    std::string name; // Warp or subroutine name
+    bool subroutine;
+    size_t begin;
+    size_t end;
+    int line; // Line count before the section
+    int test; // Test id in effect at section start
+};
+
+struct LstSectionInfo {
+    uint64_t hash = LST_HASH_SEED; // Content of every section with this name (last one for subroutines)
+    size_t firstInstruction = SIZE_MAX; // Buffer offset of the first warp instruction
+    size_t lastSection = 0;
+};
+
+struct LstScan {
+    std::vector<LstSection> sections;
+    std::set<std::string> variables;
+    std::unordered_map<std::string, LstSectionInfo> warps;
+    std::unordered_map<std::string, LstSectionInfo> subroutines;
+};
+
+struct WarpNameHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view name) const
+    {
+        return std::hash<std::string_view> {}(name);
+    }
 };
 
 class Lst::Impl {
     friend class Lst;
 
 public:
-    bool nextLine(std::string& line);
+    bool nextLine(std::string_view& line);
+
+    bool parseVariable(std::string_view line, std::string& varaiableName);
+    bool parseWarp(std::string_view line, std::string& warpName);
+    bool parseTest(std::string_view line, int& test);
+    bool parsePlugin(std::string_view line, Lst::Instruction& instruction);
+    bool parseSubroutine(std::string_view line, Lst::Instruction& instruction);
+
+    bool parseInstruction(std::string_view line, Lst::Instruction& instruction);
+    bool parsePluginInstruction(std::string_view line, Lst::Instruction& instruction);
+
+    bool readSource(const std::string& fileName);
+    void skipPlugin();
+    void skipInstruction(std::string_view line);
+    void skipSubroutine();
+    bool scanSections(LstScan& scan);
+    bool parseSection(const LstSection& section, Warp* target);
+    bool parseSubroutineSection(const LstSection& section, Instruction& instruction);
+    void storeHashes(const LstScan& scan);
 
-    bool parseVariable(const std::string& line, std::string& varaiableName);
-    bool parseWarp(const std::string& line, std::string& warpName);
-    bool parseTest(const std::string& line, int& test);
-    bool parsePlugin(const std::string& line, Lst::Instruction& instruction);
-    bool parseSubroutine(const std::string& line, Lst::Instruction& instruction);
+    bool addVariable(const std::string& name);
+    bool addInstruction(const std::string& warpName, const int& testId, Instruction&& instruction);
+    bool addInstruction(Warp& warp, int testId, Instruction&& instruction);
 
-    bool parseInstruction(const std::string& line, Lst::Instruction& instruction);
-    bool parsePluginInstruction(const std::string& line, Lst::Instruction& instruction);
+    int internWarp(std::string_view name);
+    int findWarp(std::string_view name) const;
+    const Warp* findWarp(int warpId) const;
+    InstructionBlock& addTest(Warp& warp, int testId);
 
-    bool addVariable(const std::string& name);
-    bool addInstruction(const std::string& warpName, const int& testId, const Instruction& instruction);
+    void clear();
+    bool readCache(std::span<const uint8_t> data, uint64_t expectedSourceSize);
 
 private:
-    // Parsing data
-    std::fstream m_file;
+    // Parsing data (whole file, lower cased)
+    std::string m_buffer;
+    size_t m_position = 0;
+    size_t m_end = 0;
     int m_currentLine = 0;
+    int m_nesting = 0;
 
     // Final data
     std::set<std::string> m_listVariables;
-    std::map<std::string, Warp> m_listWarps;
+    std::deque<Warp> m_listWarps; // Indexed by warp id, references stay valid while parsing
+    std::unordered_map<std::string, int, WarpNameHash, std::equal_to<>> m_warpIds;
     std::map<std::string, Instruction> m_listSubroutines;
 
-    std::string m_initWarp;
+    int m_initWarp = -1;
+
+    // Section hashes of the last parsed script, used by reloadLst
+    std::unordered_map<std::string, uint64_t> m_warpHashes;
+    std::unordered_map<std::string, uint64_t> m_subroutineHashes;
+    bool m_hashesValid = false;
 };
 
-bool Lst::Impl::nextLine(std::string& line)
+bool Lst::Impl::nextLine(std::string_view& line)
 {
-    if (!std::getline(m_file, line)) {
-        return false;
-    }
-
-    ++m_currentLine;
-
-    // Lower case the line
-    std::transform(line.begin(), line.end(), line.begin(), ::tolower);
-
-    // Remove comments
-    line = line.substr(0, line.find_first_of(';'));
-
-    // Trim the line
-    trim(line);
-
-    // Skip empty lines
-    if (line.empty()) {
-        return nextLine(line);
+    std::string_view buffer = std::string_view(m_buffer).substr(0, m_end);
+    while (m_position < buffer.size()) {
+        size_t end = std::min(buffer.find('\n', m_position), buffer.size());
+        line = buffer.substr(m_position, end - m_position);
+        m_position = end + 1;
+
+        ++m_currentLine;
+
+        // Remove comments and trim, skipping empty lines
+        line = trim(line.substr(0, line.find(';')));
+        if (!line.empty()) {
+            return true;
+        }
     }
 
-    return true;
+    return false;
 }
 
-bool Lst::Impl::parseVariable(const std::string& line, std::string& varaiableName)
+bool Lst::Impl::parseVariable(std::string_view line, std::string& varaiableName)
 {
-    if (line.find("[bool]") != std::string::npos) {
-        varaiableName = line.substr(line.find('=') + 1);
-        trim(varaiableName);
+    if (line.find("[bool]") != std::string_view::npos) {
+        varaiableName = trim(line.substr(line.find('=') + 1));
 
         return true;
     }
@@ -132,11 +379,10 @@ bool Lst::Impl::parseVariable(const std::string& line, std::string& varaiableNam
     return false;
 }
 
-bool Lst::Impl::parseWarp(const std::string& line, std::string& warpName)
+bool Lst::Impl::parseWarp(std::string_view line, std::string& warpName)
 {
-    if (line.find("[warp]") != std::string::npos) {
-        warpName = line.substr(line.find('=') + 1, line.find(',') - line.find('=') - 1);
-        trim(warpName);
+    if (line.find("[warp]") != std::string_view::npos) {
+        warpName = trim(line.substr(line.find('=') + 1, line.find(',') - line.find('=') - 1));
 
         return true;
     }
@@ -144,14 +390,20 @@ bool Lst::Impl::parseWarp(const std::string& line, std::string& warpName)
     return false;
 }
 
-bool Lst::Impl::parseTest(const std::string& line, int& test)
+bool Lst::Impl::parseTest(std::string_view line, int& test)
 {
-    if (line.find("[test]") != std::string::npos) {
-        std::string testStr = line.substr(line.find('=') + 1);
-        trim(testStr);
+    if (line.find("[test]") != std::string_view::npos) {
+        std::string_view testStr = trim(line.substr(line.find('=') + 1));
+        if (!testStr.empty() && testStr.front() == '+') {
+            testStr.remove_prefix(1);
+        }
 
         // TODO: manage optional test number (e.g. [test]=6,1)
-        test = std::stoi(testStr);
+        auto [end, error] = std::from_chars(testStr.data(), testStr.data() + testStr.size(), test);
+        if (error != std::errc()) {
+            LOG_ERROR("{} - Invalid test number: {}", m_currentLine, testStr);
+            return false;
+        }
 
         if (test < -1) {
             LOG_ERROR("{} - Invalid test number: {}", m_currentLine, test);
@@ -164,13 +416,13 @@ bool Lst::Impl::parseTest(const std::string& line, int& test)
     return false;
 }
 
-bool Lst::Impl::parsePlugin(const std::string& line, Lst::Instruction& instruction)
+bool Lst::Impl::parsePlugin(std::string_view line, Lst::Instruction& instruction)
 {
     if (line == "plugin") {
         instruction.name = "plugin";
 
         // Parse instructions
-        std::string line;
+        std::string_view line;
         while (nextLine(line)) {
             if (line == "endplugin") {
                 // End of plugin
@@ -179,7 +431,7 @@ bool Lst::Impl::parsePlugin(const std::string& line, Lst::Instruction& instructi
 
             Lst::Instruction subInstruction;
             if (parsePluginInstruction(line, subInstruction)) {
-                instruction.subInstructions.push_back(subInstruction);
+                instruction.subInstructions.push_back(std::move(subInstruction));
                 continue;
             }
 
@@ -194,15 +446,13 @@ bool Lst::Impl::parsePlugin(const std::string& line, Lst::Instruction& instructi
     return false;
 }
 
-bool Lst::Impl::parseSubroutine(const std::string& line, Lst::Instruction& instruction)
+bool Lst::Impl::parseSubroutine(std::string_view line, Lst::Instruction& instruction)
 {
-    if (line.find("label") != std::string::npos) {
-        std::string labelName = line.substr(line.find(' ') + 1);
-
-        instruction.name = labelName;
+    if (line.find("label") != std::string_view::npos) {
+        instruction.name = line.substr(line.find(' ') + 1);
 
         // Parse instructions
-        std::string line;
+        std::string_view line;
         while (nextLine(line)) {
             if (line == "return") {
                 // End of subroutine
@@ -211,13 +461,13 @@ bool Lst::Impl::parseSubroutine(const std::string& line, Lst::Instruction& instr
 
             Lst::Instruction subInstructionPlugin;
             if (parsePlugin(line, subInstructionPlugin)) {
-                instruction.subInstructions.push_back(subInstructionPlugin);
+                instruction.subInstructions.push_back(std::move(subInstructionPlugin));
                 continue;
             }
 
             Lst::Instruction subInstruction;
             if (parseInstruction(line, subInstruction)) {
-                instruction.subInstructions.push_back(subInstruction);
+                instruction.subInstructions.push_back(std::move(subInstruction));
                 continue;
             }
 
@@ -232,331 +482,945 @@ bool Lst::Impl::parseSubroutine(const std::string& line, Lst::Instruction& instr
     return false;
 }
 
-bool Lst::Impl::parseInstruction(const std::string& line, Lst::Instruction& instruction)
+bool Lst::Impl::parseInstruction(std::string_view line, Lst::Instruction& instruction)
 {
-    std::string instructionName = line.substr(0, line.find_first_of(" ="));
-    trim(instructionName);
+    size_t separator = line.find_first_of(" =");
+    std::string_view instructionName = trim(line.substr(0, separator));
+    std::string_view paramStr = trim(line.substr(separator + 1));
 
-    std::string paramStr = line.substr(line.find_first_of(" =") + 1);
-    trim(paramStr);
-
-    struct InstrTmp {
-        std::string name;
-        char separator = ',';
-    };
-    std::vector<InstrTmp> instrTmpList {
-        //{"ifand", {InstrParamType::STRING}},
-        //{"ifor", {InstrParamType::STRING}},
-        { "gotowarp" },
-        { "set", '=' },
-        { "playmusique" },
-        { "stopmusique" },
-        { "playsound" },
-        { "stopsound" },
-        { "playsound3d" },
-        { "stopsound3d" },
-        { "setcursor" },
-        { "setcursordefault" },
-        { "hidecursor" },
-        { "setangle" },
-        { "interpolangle" },
-        { "anglexmax" },
-        { "angleymax" },
-        { "return" },
-        { "end" },
-        { "fade" },
-        { "lockkey" }, // Second argument is either a string or a number (0)
-        { "resetlockkey" },
-        { "setzoom" },
-        { "gosub" },
-        { "not" }
-    };
+    const Opcode* opcode = findOpcode(instructionName);
+    if (!opcode) {
+        LOG_ERROR("{} - Unknown instruction: {}", m_currentLine, instructionName);
+        return false;
+    }
 
     if (instructionName == "ifand" || instructionName == "ifor") {
-        std::string line;
+        if (m_nesting >= LST_MAX_NESTING) {
+            LOG_ERROR("{} - Too many nested ifand/ifor", m_currentLine);
+            return false;
+        }
+
+        std::string_view line;
         if (!nextLine(line)) {
             LOG_ERROR("{} - Unexpected end of file", m_currentLine);
             return false;
         }
 
         Lst::Instruction subInstruction;
-        if (parsePlugin(line, subInstruction))
-            ;
-        else if (parseInstruction(line, subInstruction))
-            ;
-        else {
+        ++m_nesting;
+        bool parsed = parsePlugin(line, subInstruction) || parseInstruction(line, subInstruction);
+        --m_nesting;
+        if (!parsed) {
             // Error
             LOG_ERROR("{} - Unknown line in ifand/ifor: {}", m_currentLine, line);
             return false;
         }
 
-        std::vector<std::string> paramsList = split(paramStr, ',');
         instruction.name = instructionName;
-        for (const std::string& param : paramsList) {
-            instruction.params.push_back(param);
-        }
-        instruction.subInstructions.push_back(subInstruction);
+        instruction.params = split(paramStr, ',');
+        instruction.subInstructions.push_back(std::move(subInstruction));
 
         return true;
-    } else {
-        for (const InstrTmp& instrTmp : instrTmpList) {
-            if (instructionName == instrTmp.name) {
-                instruction.name = instructionName;
-                instruction.params = split(paramStr, instrTmp.separator);
-
-                // Small fix for missing Set values (like in Louvre's CD2 script)
-                if (instruction.name == "set" && instruction.params.size() < 2) {
-                    instruction.params.push_back("0");
-                }
+    }
 
-                return true;
-            }
-        }
+    instruction.name = instructionName;
+    instruction.params = split(paramStr, opcode->separator);
 
-        LOG_ERROR("{} - Unknown instruction: {}", m_currentLine, instructionName);
-        return false;
+    // Small fix for missing Set values (like in Louvre's CD2 script)
+    if (instruction.name == "set" && instruction.params.size() < 2) {
+        instruction.params.push_back("0");
     }
 
     return true;
 }
 
-bool Lst::Impl::parsePluginInstruction(const std::string& line, Lst::Instruction& instruction)
+bool Lst::Impl::parsePluginInstruction(std::string_view line, Lst::Instruction& instruction)
 {
     // Line format: funName(var1, var2, var3, ...)
 
     // Find the function name
-    std::string funName = line.substr(0, line.find('('));
-    trim(funName);
-
-    instruction.name = funName;
+    instruction.name = trim(line.substr(0, line.find('(')));
 
     // Parse parameters
-    std::string params = line.substr(line.find('(') + 1, line.find(')') - line.find('(') - 1);
+    std::string_view params = line.substr(line.find('(') + 1, line.find(')') - line.find('(') - 1);
 
-    std::vector<std::string> paramsList = split(params, ',');
-    for (const std::string& param : paramsList) {
-        std::string paramTmp = param;
+    split(params, ',', [&](std::string_view param) {
         // Remove '"' if it exists
-        if (param.front() == '"' && param.back() == '"') {
-            paramTmp = paramTmp.substr(1, paramTmp.size() - 2);
+        if (!param.empty() && param.front() == '"' && param.back() == '"') {
+            param = param.substr(1, param.size() - 2);
         }
 
         // Replace '\' by '/'
+        std::string& paramTmp = instruction.params.emplace_back(param);
         std::replace(paramTmp.begin(), paramTmp.end(), '\\', '/');
-
-        instruction.params.push_back(paramTmp);
-    }
+    });
 
     return true;
 }
 
-bool Lst::Impl::addVariable(const std::string& name)
-{
-    m_listVariables.insert(name);
-
-    return true;
-}
-
-bool Lst::Impl::addInstruction(
-    const std::string& warpName, const int& testId,
-    const Instruction& instruction)
+bool Lst::Impl::readSource(const std::string& fileName)
 {
-    // Register warp
-    if (m_listWarps.empty()) {
-        m_initWarp = warpName;
-    }
-
-    if (m_listWarps.find(warpName) == m_listWarps.end()) {
-        Warp warp;
-        warp.name = warpName;
-        m_listWarps[warpName] = warp;
-    }
-
-    // Add instruction
-    if (testId == -1) {
-        m_listWarps[warpName].initBlock.push_back(instruction);
-        return true;
-    }
-
-    // Register test
-    if (m_listWarps[warpName].testBlockList.empty()) {
-        m_listWarps[warpName].testBlockList[testId] = InstructionBlock();
+    // Whole file is loaded and lower cased once, lines are then parsed in place
+    ofnx::tools::RandomAccessFile file;
+    if (!file.open(fileName)) {
+        LOG_ERROR("Could not open file: {}", fileName);
+        return false;
     }
 
-    if (testId < 0) {
+    m_buffer.resize(file.size());
+    if (!file.read(0, m_buffer.size(), reinterpret_cast<uint8_t*>(m_buffer.data()))) {
+        LOG_ERROR("Could not read file: {}", fileName);
+        m_buffer.clear();
         return false;
     }
+    file.close();
 
-    m_listWarps[warpName].testBlockList[testId].push_back(instruction);
+    for (char& c : m_buffer) {
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+    }
 
     return true;
 }
 
-/* PUBLIC */
-Lst::Lst()
+void Lst::Impl::skipPlugin()
 {
-    d_ptr = new Impl;
+    std::string_view line;
+    while (nextLine(line) && line != "endplugin") {
+    }
 }
 
-Lst::~Lst()
+void Lst::Impl::skipInstruction(std::string_view line)
 {
-    delete d_ptr;
+    // Same rule as parseInstruction, ifand/ifor take the next line
+    while (true) {
+        if (line == "plugin") {
+            skipPlugin();
+            return;
+        }
+
+        std::string_view instructionName = trim(line.substr(0, line.find_first_of(" =")));
+        if ((instructionName != "ifand" && instructionName != "ifor") || !nextLine(line)) {
+            return;
+        }
+    }
 }
 
-bool Lst::parseLst(const std::string& fileName)
+void Lst::Impl::skipSubroutine()
 {
-    d_ptr->m_file.open(fileName);
-    if (!d_ptr->m_file) {
-        LOG_ERROR("Could not open file: {}", fileName);
-        return false;
+    std::string_view line;
+    while (nextLine(line) && line != "return") {
+        skipInstruction(line);
     }
+}
+
+bool Lst::Impl::scanSections(LstScan& scan)
+{
+    // Splits the script without parsing instructions, following the parseLst line rules
+    m_position = 0;
+    m_end = m_buffer.size();
+    m_currentLine = 0;
 
     std::string currentWarp;
     int currentTest = -2;
+    bool sectionOpen = false;
+    bool sectionMarked = false;
+
+    auto openSection = [&](const std::string& name, bool subroutine, size_t begin, int line) {
+        if (!name.empty()) {
+            scan.sections.push_back({ name, subroutine, begin, begin, line, currentTest });
+            sectionOpen = true;
+            sectionMarked = false;
+        }
+    };
 
-    d_ptr->m_currentLine = 0;
-    std::string line;
-    while (d_ptr->nextLine(line)) {
-        std::string var;
-        if (d_ptr->parseVariable(line, var)) {
-            d_ptr->addVariable(var);
-            continue;
+    auto closeSection = [&](size_t end) {
+        if (!sectionOpen) {
+            return;
         }
 
-        if (d_ptr->parseWarp(line, currentWarp)) {
-            continue;
+        LstSection& section = scan.sections.back();
+        section.end = std::min(end, m_buffer.size());
+        std::string_view content = std::string_view(m_buffer).substr(section.begin, section.end - section.begin);
+
+        if (section.subroutine) {
+            LstSectionInfo& info = scan.subroutines[section.name];
+            info.hash = hashBytes(LST_HASH_SEED, content);
+            info.lastSection = scan.sections.size() - 1;
+        } else {
+            LstSectionInfo& info = scan.warps[section.name];
+            info.hash = hashBytes(info.hash, std::string_view(reinterpret_cast<const char*>(&section.test), sizeof(section.test)));
+            info.hash = hashBytes(info.hash, content);
         }
 
-        if (d_ptr->parseTest(line, currentTest)) {
-            if (currentWarp.empty()) {
-                LOG_ERROR("{} - [test] fount before [warp]", d_ptr->m_currentLine);
-                return false;
+        sectionOpen = false;
+    };
+
+    auto markInstruction = [&](size_t offset) {
+        // Only the first instruction of a section can be the first one of its warp
+        if (!sectionMarked) {
+            LstSectionInfo& info = scan.warps[currentWarp];
+            info.firstInstruction = std::min(info.firstInstruction, offset);
+            sectionMarked = true;
+        }
+    };
+
+    while (true) {
+        size_t lineBegin = std::min(m_position, m_end);
+        int lineNumber = m_currentLine;
+
+        std::string_view line;
+        if (!nextLine(line)) {
+            break;
+        }
+
+        // Headers all contain a bracket, most lines are instructions
+        if (line.find('[') != std::string_view::npos) {
+            std::string var;
+            if (parseVariable(line, var)) {
+                scan.variables.insert(var);
+                continue;
             }
 
-            continue;
+            if (parseWarp(line, currentWarp)) {
+                closeSection(lineBegin);
+                openSection(currentWarp, false, lineBegin, lineNumber);
+                continue;
+            }
+
+            if (parseTest(line, currentTest)) {
+                if (currentWarp.empty()) {
+                    LOG_ERROR("{} - [test] fount before [warp]", m_currentLine);
+                    return false;
+                }
+
+                continue;
+            }
         }
 
-        Lst::Instruction instructionPlugin;
-        if (d_ptr->parsePlugin(line, instructionPlugin)) {
+        if (line == "plugin") {
             if (currentWarp.empty()) {
-                LOG_ERROR("{} - Plugin found before [warp]", d_ptr->m_currentLine);
+                LOG_ERROR("{} - Plugin found before [warp]", m_currentLine);
                 return false;
             }
 
-            d_ptr->addInstruction(currentWarp, currentTest, instructionPlugin);
+            markInstruction(lineBegin);
+            skipPlugin();
             continue;
         }
 
-        Lst::Instruction instructionSubroutine;
-        if (d_ptr->parseSubroutine(line, instructionSubroutine)) {
-            d_ptr->m_listSubroutines[instructionSubroutine.name] = instructionSubroutine;
+        if (line.find("label") != std::string_view::npos) {
+            closeSection(lineBegin);
+            openSection(std::string(line.substr(line.find(' ') + 1)), true, lineBegin, lineNumber);
+            skipSubroutine();
+            closeSection(m_position);
+
+            // Warp section goes on after the subroutine
+            openSection(currentWarp, false, std::min(m_position, m_end), m_currentLine);
             continue;
         }
 
-        Lst::Instruction instruction;
-        if (d_ptr->parseInstruction(line, instruction)) {
-            if (currentWarp.empty()) {
-                LOG_ERROR("{} - Instruction found before [warp]", d_ptr->m_currentLine);
-                return false;
-            }
-
-            d_ptr->addInstruction(currentWarp, currentTest, instruction);
-            continue;
+        if (currentWarp.empty()) {
+            LOG_ERROR("{} - Instruction found before [warp]", m_currentLine);
+            return false;
         }
 
-        LOG_ERROR("{} - Unknown line: {}", d_ptr->m_currentLine, line);
-        d_ptr->m_file.close();
-        return false;
+        markInstruction(lineBegin);
+        skipInstruction(line);
     }
-    d_ptr->m_file.close();
+    closeSection(m_end);
 
     return true;
 }
 
-std::string instructionToString(const Lst::Instruction& instruction, int level)
+bool Lst::Impl::parseSection(const LstSection& section, Warp* target)
 {
-    std::string str;
-    for (int i = 0; i < level; ++i) {
-        str += "\t";
-    }
-
-    if (instruction.name == "ifand" || instruction.name == "ifor") {
-        bool first = true;
-        for (const auto& subInstruction : instruction.subInstructions) {
-            if (first) {
-                first = false;
-            } else {
-                for (int i = 0; i < level; ++i) {
-                    str += "\t";
-                }
-            }
-            str += instruction.name + "=";
-            for (const std::string& param : instruction.params) {
-                str += param;
-                if (&param != &instruction.params.back()) {
-                    str += ",";
-                }
-            }
-            str += "\n";
-            str += instructionToString(subInstruction, level + 1);
-            if (&subInstruction != &instruction.subInstructions.back()) {
-                str += "\n";
-            }
-        }
-
-        return str;
-    } else if (instruction.name == "plugin") {
-        str += "plugin\n";
-        for (const auto& subInstruction : instruction.subInstructions) {
-            for (int i = 0; i < level + 1; ++i) {
-                str += "\t";
-            }
-            str += subInstruction.name + "(";
-            for (const auto& param : subInstruction.params) {
-                str += param;
-                if (&param != &subInstruction.params.back()) {
-                    str += ",";
-                }
-            }
-            str += ")\n";
+    m_position = section.begin;
+    m_end = section.end;
+    m_currentLine = section.line;
+
+    int currentTest = section.test;
+    std::string_view line;
+    while (nextLine(line)) {
+        // Variables are collected by scanSections, the [warp] line opens the section
+        std::string name;
+        if (parseVariable(line, name) || parseWarp(line, name)) {
+            continue;
         }
 
-        for (int i = 0; i < level; ++i) {
-            str += "\t";
-        }
-        str += "endplugin";
-    } else if (instruction.name == "setzoom") {
-        str += instruction.name + "=" + instruction.params[0];
-    } else if (instruction.name == "gotowarp") {
-        str += instruction.name + "=" + instruction.params[0];
-    } else if (instruction.name == "set") {
-        str += instruction.name + " "
-            + instruction.params[0] + "="
-            + instruction.params[1];
-    } else {
-        str += instruction.name;
-        if (instruction.params.empty()) {
-            return str;
+        if (parseTest(line, currentTest)) {
+            continue;
         }
-        str += " ";
-        for (const auto& param : instruction.params) {
-            str += param;
 
-            if (&param != &instruction.params.back()) {
-                str += ",";
+        Lst::Instruction instruction;
+        if (parsePlugin(line, instruction) || parseInstruction(line, instruction)) {
+            if (target) {
+                addInstruction(*target, currentTest, std::move(instruction));
+            } else {
+                addInstruction(section.name, currentTest, std::move(instruction));
             }
+            continue;
         }
+
+        LOG_ERROR("{} - Unknown line: {}", m_currentLine, line);
+        return false;
     }
 
-    return str;
+    return true;
 }
 
-void printWarp(std::ofstream& file, const std::string& warpName, const Warp& warp)
+bool Lst::Impl::parseSubroutineSection(const LstSection& section, Instruction& instruction)
 {
-    file << "[warp]=" << warpName << "," << warpName.substr(0, warpName.size() - 3) << ".tst" << std::endl;
+    m_position = section.begin;
+    m_end = section.end;
+    m_currentLine = section.line;
 
-    // Init block
-    if (!warp.initBlock.empty()) {
+    std::string_view line;
+    if (!nextLine(line) || !parseSubroutine(line, instruction)) {
+        LOG_ERROR("{} - Invalid subroutine: {}", m_currentLine, section.name);
+        return false;
+    }
+
+    return true;
+}
+
+void Lst::Impl::storeHashes(const LstScan& scan)
+{
+    m_warpHashes.clear();
+    for (const auto& [name, info] : scan.warps) {
+        m_warpHashes[name] = info.hash;
+    }
+
+    m_subroutineHashes.clear();
+    for (const auto& [name, info] : scan.subroutines) {
+        m_subroutineHashes[name] = info.hash;
+    }
+
+    m_hashesValid = true;
+}
+
+bool Lst::Impl::addVariable(const std::string& name)
+{
+    m_listVariables.insert(name);
+
+    return true;
+}
+
+bool Lst::Impl::addInstruction(
+    const std::string& warpName, const int& testId,
+    Instruction&& instruction)
+{
+    // Register warp
+    int warpId = internWarp(warpName);
+    if (m_initWarp < 0) {
+        m_initWarp = warpId;
+    }
+
+    return addInstruction(m_listWarps[warpId], testId, std::move(instruction));
+}
+
+bool Lst::Impl::addInstruction(Warp& warp, int testId, Instruction&& instruction)
+{
+    if (testId == -1) {
+        warp.initBlock.push_back(std::move(instruction));
+        return true;
+    }
+
+    if (testId < 0 || testId > LST_MAX_TEST_ID) {
+        LOG_ERROR("{} - Invalid test number: {}", m_currentLine, testId);
+        return false;
+    }
+
+    addTest(warp, testId).push_back(std::move(instruction));
+
+    return true;
+}
+
+int Lst::Impl::internWarp(std::string_view name)
+{
+    int warpId = findWarp(name);
+    if (warpId >= 0) {
+        return warpId;
+    }
+
+    warpId = m_listWarps.size();
+    m_listWarps.emplace_back().name = name;
+    m_warpIds.emplace(name, warpId);
+
+    return warpId;
+}
+
+int Lst::Impl::findWarp(std::string_view name) const
+{
+    auto it = m_warpIds.find(name);
+    if (it == m_warpIds.end()) {
+        return -1;
+    }
+
+    return it->second;
+}
+
+const Warp* Lst::Impl::findWarp(int warpId) const
+{
+    if (warpId < 0 || warpId >= m_listWarps.size()) {
+        return nullptr;
+    }
+
+    return &m_listWarps[warpId];
+}
+
+Lst::InstructionBlock& Lst::Impl::addTest(Warp& warp, int testId)
+{
+    if (testId >= warp.testBlockList.size()) {
+        warp.testBlockList.resize(testId + 1);
+        warp.testPresent.resize(testId + 1, 0);
+    }
+
+    warp.testPresent[testId] = 1;
+
+    return warp.testBlockList[testId];
+}
+
+void Lst::Impl::clear()
+{
+    m_listVariables.clear();
+    m_listWarps.clear();
+    m_warpIds.clear();
+    m_listSubroutines.clear();
+    m_initWarp = -1;
+
+    m_warpHashes.clear();
+    m_subroutineHashes.clear();
+    m_hashesValid = false;
+}
+
+/*
+ * Builds the cache words, strings are interned on the fly
+ */
+class LstCacheWriter {
+public:
+    uint32_t string(const std::string& str)
+    {
+        auto [it, inserted] = m_stringIds.try_emplace(str, m_strings.size());
+        if (inserted) {
+            m_strings.push_back(&it->first);
+        }
+
+        return it->second;
+    }
+
+    // Block nodes are contiguous, children are always stored after their parent
+    uint32_t block(const Lst::InstructionBlock& block)
+    {
+        uint32_t first = m_nodes.size() / LST_CACHE_NODE_WORDS;
+        m_nodes.resize(m_nodes.size() + block.size() * LST_CACHE_NODE_WORDS);
+
+        for (size_t i = 0; i < block.size(); ++i) {
+            const Lst::Instruction& instruction = block[i];
+
+            uint32_t name = string(instruction.name);
+            uint32_t firstParam = m_params.size();
+            for (const std::string& param : instruction.params) {
+                m_params.push_back(string(param));
+            }
+            uint32_t firstChild = this->block(instruction.subInstructions);
+
+            uint32_t* node = &m_nodes[(first + i) * LST_CACHE_NODE_WORDS];
+            node[0] = name;
+            node[1] = firstParam;
+            node[2] = instruction.params.size();
+            node[3] = firstChild;
+            node[4] = instruction.subInstructions.size();
+        }
+
+        return first;
+    }
+
+public:
+    std::unordered_map<std::string, uint32_t> m_stringIds;
+    std::vector<const std::string*> m_strings;
+    std::vector<uint32_t> m_variables;
+    std::vector<uint32_t> m_nodes;
+    std::vector<uint32_t> m_params;
+    std::vector<uint32_t> m_warps;
+    std::vector<uint32_t> m_tests;
+};
+
+bool Lst::Impl::readCache(std::span<const uint8_t> data, uint64_t expectedSourceSize)
+{
+    auto word = [&](uint64_t index) {
+        const uint8_t* p = data.data() + index * 4;
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    };
+
+    m_hashesValid = false;
+
+    if (data.size() < LST_CACHE_FIELD_COUNT * 4) {
+        LOG_ERROR("Cache file too small");
+        return false;
+    }
+
+    uint32_t header[LST_CACHE_FIELD_COUNT];
+    for (int i = 0; i < LST_CACHE_FIELD_COUNT; ++i) {
+        header[i] = word(i);
+    }
+
+    if (header[LST_CACHE_FIELD_MAGIC] != LST_CACHE_MAGIC || header[LST_CACHE_FIELD_VERSION] != LST_CACHE_VERSION) {
+        LOG_ERROR("Wrong cache header or version");
+        return false;
+    }
+
+    uint64_t sourceSize = header[LST_CACHE_FIELD_SOURCE_SIZE_LOW] | (uint64_t(header[LST_CACHE_FIELD_SOURCE_SIZE_HIGH]) << 32);
+    if (expectedSourceSize != UINT64_MAX && sourceSize != expectedSourceSize) {
+        LOG_ERROR("Cache does not match source file");
+        return false;
+    }
+
+    // Every section must fit in the file
+    auto checkSection = [&](LstCacheField offsetField, uint64_t words) {
+        uint64_t offset = header[offsetField];
+        return offset % 4 == 0 && offset <= data.size() && words * 4 <= data.size() - offset;
+    };
+
+    uint32_t stringCount = header[LST_CACHE_FIELD_STRING_COUNT];
+    uint32_t nodeCount = header[LST_CACHE_FIELD_NODE_COUNT];
+    uint32_t paramCount = header[LST_CACHE_FIELD_PARAM_COUNT];
+    uint32_t warpCount = header[LST_CACHE_FIELD_WARP_COUNT];
+    uint32_t testCount = header[LST_CACHE_FIELD_TEST_COUNT];
+    uint64_t stringDataOffset = header[LST_CACHE_FIELD_STRING_DATA_OFFSET];
+    uint64_t stringDataSize = header[LST_CACHE_FIELD_STRING_DATA_SIZE];
+
+    if (!checkSection(LST_CACHE_FIELD_STRING_INDEX_OFFSET, uint64_t(stringCount) * 2)
+        || !checkSection(LST_CACHE_FIELD_VARIABLES_OFFSET, header[LST_CACHE_FIELD_VARIABLE_COUNT])
+        || !checkSection(LST_CACHE_FIELD_NODES_OFFSET, uint64_t(nodeCount) * LST_CACHE_NODE_WORDS)
+        || !checkSection(LST_CACHE_FIELD_PARAMS_OFFSET, paramCount)
+        || !checkSection(LST_CACHE_FIELD_WARPS_OFFSET, uint64_t(warpCount) * LST_CACHE_WARP_WORDS)
+        || !checkSection(LST_CACHE_FIELD_TESTS_OFFSET, uint64_t(testCount) * LST_CACHE_TEST_WORDS)
+        || stringDataOffset > data.size() || stringDataSize > data.size() - stringDataOffset) {
+        LOG_ERROR("Corrupted cache file");
+        return false;
+    }
+
+    // Strings are views into the mapped data until copied into the final structures
+    std::vector<std::string_view> strings(stringCount);
+    uint64_t stringIndex = header[LST_CACHE_FIELD_STRING_INDEX_OFFSET] / 4;
+    for (uint32_t i = 0; i < stringCount; ++i) {
+        uint64_t offset = word(stringIndex + i * 2);
+        uint64_t size = word(stringIndex + i * 2 + 1);
+        if (offset > stringDataSize || size > stringDataSize - offset) {
+            LOG_ERROR("Corrupted cache string table");
+            return false;
+        }
+
+        strings[i] = std::string_view(reinterpret_cast<const char*>(data.data() + stringDataOffset + offset), size);
+    }
+
+    auto string = [&](uint32_t id, std::string_view& str) {
+        if (id >= stringCount) {
+            return false;
+        }
+
+        str = strings[id];
+        return true;
+    };
+
+    uint64_t nodes = header[LST_CACHE_FIELD_NODES_OFFSET] / 4;
+    uint64_t params = header[LST_CACHE_FIELD_PARAMS_OFFSET] / 4;
+
+    // Walked with an explicit stack, depth is capped to what the parser produces.
+    // Children are stored after their parent and every node is read at most once.
+    struct PendingBlock {
+        uint64_t parent;
+        uint64_t first;
+        uint64_t count;
+        int depth;
+        InstructionBlock* block;
+    };
+    std::vector<PendingBlock> pending;
+    uint64_t nodesRead = 0;
+
+    auto readBlock = [&](uint64_t parent, uint64_t first, uint64_t count, InstructionBlock& root) {
+        pending.clear();
+        pending.push_back({ parent, first, count, 0, &root });
+
+        while (!pending.empty()) {
+            PendingBlock current = pending.back();
+            pending.pop_back();
+
+            if (current.count == 0) {
+                continue;
+            }
+
+            if ((current.parent != UINT64_MAX && current.first <= current.parent) || current.first > nodeCount
+                || current.count > nodeCount - current.first || current.count > nodeCount - nodesRead
+                || current.depth >= LST_CACHE_MAX_DEPTH) {
+                return false;
+            }
+            nodesRead += current.count;
+
+            // Not resized afterwards, children keep pointers into it
+            InstructionBlock& block = *current.block;
+            block.resize(current.count);
+            for (uint64_t i = 0; i < current.count; ++i) {
+                uint64_t node = nodes + (current.first + i) * LST_CACHE_NODE_WORDS;
+                Instruction& instruction = block[i];
+
+                std::string_view name;
+                if (!string(word(node), name)) {
+                    return false;
+                }
+                instruction.name = name;
+
+                uint64_t firstParam = word(node + 1);
+                uint64_t paramsSize = word(node + 2);
+                if (firstParam > paramCount || paramsSize > paramCount - firstParam) {
+                    return false;
+                }
+
+                instruction.params.resize(paramsSize);
+                for (uint64_t j = 0; j < paramsSize; ++j) {
+                    std::string_view param;
+                    if (!string(word(params + firstParam + j), param)) {
+                        return false;
+                    }
+                    instruction.params[j] = param;
+                }
+
+                pending.push_back({ current.first + i, word(node + 3), word(node + 4), current.depth + 1, &instruction.subInstructions });
+            }
+        }
+
+        return true;
+    };
+
+    // Variables
+    uint64_t variables = header[LST_CACHE_FIELD_VARIABLES_OFFSET] / 4;
+    for (uint32_t i = 0; i < header[LST_CACHE_FIELD_VARIABLE_COUNT]; ++i) {
+        std::string_view variable;
+        if (!string(word(variables + i), variable)) {
+            LOG_ERROR("Corrupted cache variables");
+            return false;
+        }
+        m_listVariables.emplace(variable);
+    }
+
+    // Warps
+    uint64_t warps = header[LST_CACHE_FIELD_WARPS_OFFSET] / 4;
+    uint64_t tests = header[LST_CACHE_FIELD_TESTS_OFFSET] / 4;
+    for (uint32_t i = 0; i < warpCount; ++i) {
+        uint64_t warpWord = warps + i * LST_CACHE_WARP_WORDS;
+
+        std::string_view name;
+        if (!string(word(warpWord), name)) {
+            LOG_ERROR("Corrupted cache warps");
+            return false;
+        }
+
+        if (findWarp(name) >= 0) {
+            LOG_ERROR("Corrupted cache warps");
+            return false;
+        }
+
+        Warp& warp = m_listWarps[internWarp(name)];
+        if (!readBlock(UINT64_MAX, word(warpWord + 1), word(warpWord + 2), warp.initBlock)) {
+            LOG_ERROR("Corrupted cache init block: {}", name);
+            return false;
+        }
+
+        uint64_t firstTest = word(warpWord + 3);
+        uint64_t testsSize = word(warpWord + 4);
+        if (firstTest > testCount || testsSize > testCount - firstTest) {
+            LOG_ERROR("Corrupted cache tests: {}", name);
+            return false;
+        }
+
+        for (uint64_t j = 0; j < testsSize; ++j) {
+            uint64_t testWord = tests + (firstTest + j) * LST_CACHE_TEST_WORDS;
+            uint32_t testId = word(testWord);
+            if (testId > LST_MAX_TEST_ID) {
+                LOG_ERROR("Corrupted cache test id: {}", name);
+                return false;
+            }
+
+            InstructionBlock& block = addTest(warp, testId);
+            if (!readBlock(UINT64_MAX, word(testWord + 1), word(testWord + 2), block)) {
+                LOG_ERROR("Corrupted cache test block: {}", name);
+                return false;
+            }
+        }
+    }
+
+    // Subroutines
+    InstructionBlock subroutines;
+    if (!readBlock(UINT64_MAX, header[LST_CACHE_FIELD_SUBROUTINE_FIRST], header[LST_CACHE_FIELD_SUBROUTINE_COUNT], subroutines)) {
+        LOG_ERROR("Corrupted cache subroutines");
+        return false;
+    }
+
+    for (Instruction& subroutine : subroutines) {
+        std::string name = subroutine.name;
+        m_listSubroutines[name] = std::move(subroutine);
+    }
+
+    m_initWarp = -1;
+    if (header[LST_CACHE_FIELD_INIT_WARP] != LST_CACHE_NONE) {
+        m_initWarp = header[LST_CACHE_FIELD_INIT_WARP];
+        if (m_initWarp < 0 || m_initWarp >= m_listWarps.size()) {
+            LOG_ERROR("Corrupted cache init warp");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* PUBLIC */
+Lst::Lst()
+{
+    d_ptr = new Impl;
+}
+
+Lst::~Lst()
+{
+    delete d_ptr;
+}
+
+bool Lst::parseLst(const std::string& fileName)
+{
+    bool wasEmpty = d_ptr->m_listWarps.empty() && d_ptr->m_listSubroutines.empty() && d_ptr->m_listVariables.empty();
+    d_ptr->m_hashesValid = false;
+
+    if (!d_ptr->readSource(fileName)) {
+        return false;
+    }
+
+    LstScan scan;
+    if (!d_ptr->scanSections(scan)) {
+        d_ptr->m_buffer.clear();
+        return false;
+    }
+
+    for (const std::string& var : scan.variables) {
+        d_ptr->addVariable(var);
+    }
+
+    for (const LstSection& section : scan.sections) {
+        if (section.subroutine) {
+            Lst::Instruction instructionSubroutine;
+            if (!d_ptr->parseSubroutineSection(section, instructionSubroutine)) {
+                d_ptr->m_buffer.clear();
+                return false;
+            }
+
+            d_ptr->m_listSubroutines[instructionSubroutine.name] = std::move(instructionSubroutine);
+        } else if (!d_ptr->parseSection(section, nullptr)) {
+            d_ptr->m_buffer.clear();
+            return false;
+        }
+    }
+    d_ptr->m_buffer.clear();
+
+    // Hashes only describe the data if nothing was loaded before
+    if (wasEmpty) {
+        d_ptr->storeHashes(scan);
+    }
+
+    return true;
+}
+
+bool Lst::reloadLst(const std::string& fileName)
+{
+    if (!d_ptr->m_hashesValid) {
+        d_ptr->clear();
+        return parseLst(fileName);
+    }
+
+    if (!d_ptr->readSource(fileName)) {
+        return false;
+    }
+
+    LstScan scan;
+    if (!d_ptr->scanSections(scan)) {
+        d_ptr->m_buffer.clear();
+        return false;
+    }
+
+    // Changed sections are parsed aside, current data is kept on error
+    std::unordered_map<std::string, Warp> warps;
+    for (const auto& [name, info] : scan.warps) {
+        auto previous = d_ptr->m_warpHashes.find(name);
+        if (previous == d_ptr->m_warpHashes.end() || previous->second != info.hash) {
+            warps[name].name = name;
+        }
+    }
+
+    std::map<std::string, Instruction> subroutines;
+    for (size_t i = 0; i < scan.sections.size(); ++i) {
+        const LstSection& section = scan.sections[i];
+        bool success = true;
+
+        if (section.subroutine) {
+            const LstSectionInfo& info = scan.subroutines[section.name];
+            auto previous = d_ptr->m_subroutineHashes.find(section.name);
+            if (info.lastSection == i && (previous == d_ptr->m_subroutineHashes.end() || previous->second != info.hash)) {
+                Lst::Instruction instructionSubroutine;
+                success = d_ptr->parseSubroutineSection(section, instructionSubroutine);
+                subroutines[instructionSubroutine.name] = std::move(instructionSubroutine);
+            }
+        } else {
+            auto warp = warps.find(section.name);
+            if (warp != warps.end()) {
+                success = d_ptr->parseSection(section, &warp->second);
+            }
+        }
+
+        if (!success) {
+            d_ptr->m_buffer.clear();
+            return false;
+        }
+    }
+    d_ptr->m_buffer.clear();
+
+    // Removed warps keep their id with empty blocks
+    for (const auto& [name, hash] : d_ptr->m_warpHashes) {
+        int warpId = d_ptr->findWarp(name);
+        if (warpId >= 0 && !scan.warps.contains(name)) {
+            Warp& warp = d_ptr->m_listWarps[warpId];
+            warp.initBlock.clear();
+            warp.testBlockList.clear();
+            warp.testPresent.clear();
+        }
+    }
+
+    // New warps are numbered in order of first instruction, as parseLst does
+    std::vector<std::pair<size_t, Warp*>> changedWarps;
+    for (auto& [name, warp] : warps) {
+        changedWarps.push_back({ scan.warps[name].firstInstruction, &warp });
+    }
+    std::sort(changedWarps.begin(), changedWarps.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    for (auto [firstInstruction, staged] : changedWarps) {
+        int warpId = d_ptr->findWarp(staged->name);
+        if (warpId < 0) {
+            if (firstInstruction == SIZE_MAX) {
+                continue;
+            }
+
+            warpId = d_ptr->internWarp(staged->name);
+        }
+
+        Warp& warp = d_ptr->m_listWarps[warpId];
+        warp.initBlock = std::move(staged->initBlock);
+        warp.testBlockList = std::move(staged->testBlockList);
+        warp.testPresent = std::move(staged->testPresent);
+    }
+
+    std::erase_if(d_ptr->m_listSubroutines, [&](const auto& subroutine) { return !scan.subroutines.contains(subroutine.first); });
+    for (auto& [name, instruction] : subroutines) {
+        d_ptr->m_listSubroutines[name] = std::move(instruction);
+    }
+
+    d_ptr->m_listVariables = std::move(scan.variables);
+
+    d_ptr->m_initWarp = -1;
+    size_t initOffset = SIZE_MAX;
+    for (const auto& [name, info] : scan.warps) {
+        if (info.firstInstruction < initOffset) {
+            initOffset = info.firstInstruction;
+            d_ptr->m_initWarp = d_ptr->findWarp(name);
+        }
+    }
+
+    d_ptr->storeHashes(scan);
+
+    return true;
+}
+
+std::string instructionToString(const Lst::Instruction& instruction, int level)
+{
+    std::string str;
+    for (int i = 0; i < level; ++i) {
+        str += "\t";
+    }
+
+    if (instruction.name == "ifand" || instruction.name == "ifor") {
+        bool first = true;
+        for (const auto& subInstruction : instruction.subInstructions) {
+            if (first) {
+                first = false;
+            } else {
+                for (int i = 0; i < level; ++i) {
+                    str += "\t";
+                }
+            }
+            str += instruction.name + "=";
+            for (const std::string& param : instruction.params) {
+                str += param;
+                if (&param != &instruction.params.back()) {
+                    str += ",";
+                }
+            }
+            str += "\n";
+            str += instructionToString(subInstruction, level + 1);
+            if (&subInstruction != &instruction.subInstructions.back()) {
+                str += "\n";
+            }
+        }
+
+        return str;
+    } else if (instruction.name == "plugin") {
+        str += "plugin\n";
+        for (const auto& subInstruction : instruction.subInstructions) {
+            for (int i = 0; i < level + 1; ++i) {
+                str += "\t";
+            }
+            str += subInstruction.name + "(";
+            for (const auto& param : subInstruction.params) {
+                str += param;
+                if (&param != &subInstruction.params.back()) {
+                    str += ",";
+                }
+            }
+            str += ")\n";
+        }
+
+        for (int i = 0; i < level; ++i) {
+            str += "\t";
+        }
+        str += "endplugin";
+    } else if (instruction.name == "setzoom") {
+        str += instruction.name + "=" + instruction.params[0];
+    } else if (instruction.name == "gotowarp") {
+        str += instruction.name + "=" + instruction.params[0];
+    } else if (instruction.name == "set") {
+        str += instruction.name + " "
+            + instruction.params[0] + "="
+            + instruction.params[1];
+    } else {
+        str += instruction.name;
+        if (instruction.params.empty()) {
+            return str;
+        }
+        str += " ";
+        for (const auto& param : instruction.params) {
+            str += param;
+
+            if (&param != &instruction.params.back()) {
+                str += ",";
+            }
+        }
+    }
+
+    return str;
+}
+
+void printWarp(std::ofstream& file, const std::string& warpName, const Warp& warp)
+{
+    file << "[warp]=" << warpName << "," << warpName.substr(0, warpName.size() - 3) << ".tst" << std::endl;
+
+    // Init block
+    if (!warp.initBlock.empty()) {
         file << "\t[test]=-1" << std::endl;
         for (const auto& instruction : warp.initBlock) {
             file << instructionToString(instruction, 2) << std::endl;
@@ -564,9 +1428,13 @@ void printWarp(std::ofstream& file, const std::string& warpName, const Warp& war
     }
 
     // Tests
-    for (const auto& test : warp.testBlockList) {
-        file << "\t[test]=" << test.first << std::endl;
-        for (const auto& instruction : test.second) {
+    for (size_t testId = 0; testId < warp.testBlockList.size(); ++testId) {
+        if (!warp.hasTest(testId)) {
+            continue;
+        }
+
+        file << "\t[test]=" << testId << std::endl;
+        for (const auto& instruction : warp.testBlockList[testId]) {
             file << instructionToString(instruction, 2) << std::endl;
         }
     }
@@ -585,14 +1453,22 @@ bool Lst::saveLst(const std::string& fileName)
         file << "[bool]=" << var << std::endl;
     }
 
-    // Warps
-    printWarp(file, d_ptr->m_initWarp, d_ptr->m_listWarps[d_ptr->m_initWarp]);
-    for (const auto& warp : d_ptr->m_listWarps) {
-        if (warp.first == d_ptr->m_initWarp) {
+    // Warps (initial one first, then by name)
+    std::vector<const Warp*> warps;
+    for (const Warp& warp : d_ptr->m_listWarps) {
+        warps.push_back(&warp);
+    }
+    std::sort(warps.begin(), warps.end(), [](const Warp* a, const Warp* b) { return a->name < b->name; });
+
+    if (const Warp* initWarp = d_ptr->findWarp(d_ptr->m_initWarp)) {
+        printWarp(file, initWarp->name, *initWarp);
+    }
+    for (const Warp* warp : warps) {
+        if (warp == d_ptr->findWarp(d_ptr->m_initWarp)) {
             continue;
         }
 
-        printWarp(file, warp.first, warp.second);
+        printWarp(file, warp->name, *warp);
     }
 
     // Subroutines
@@ -609,6 +1485,169 @@ bool Lst::saveLst(const std::string& fileName)
     return true;
 }
 
+bool Lst::saveCache(const std::string& fileName, uint64_t sourceSize) const
+{
+    LstCacheWriter writer;
+
+    for (const std::string& variable : d_ptr->m_listVariables) {
+        writer.m_variables.push_back(writer.string(variable));
+    }
+
+    // Warps are stored in id order so ids survive a cache round trip
+    for (const Warp& warp : d_ptr->m_listWarps) {
+        uint32_t nameId = writer.string(warp.name);
+        uint32_t initFirst = writer.block(warp.initBlock);
+        uint32_t testFirst = writer.m_tests.size() / LST_CACHE_TEST_WORDS;
+
+        uint32_t testCount = 0;
+        for (size_t testId = 0; testId < warp.testBlockList.size(); ++testId) {
+            if (!warp.hasTest(testId)) {
+                continue;
+            }
+
+            const InstructionBlock& block = warp.testBlockList[testId];
+            uint32_t nodeFirst = writer.block(block);
+            writer.m_tests.insert(writer.m_tests.end(), { uint32_t(testId), nodeFirst, uint32_t(block.size()) });
+            ++testCount;
+        }
+
+        writer.m_warps.insert(writer.m_warps.end(), { nameId, initFirst, uint32_t(warp.initBlock.size()), testFirst, testCount });
+    }
+
+    InstructionBlock subroutines;
+    for (const auto& subroutine : d_ptr->m_listSubroutines) {
+        subroutines.push_back(subroutine.second);
+    }
+    uint32_t subroutineFirst = writer.block(subroutines);
+
+    uint32_t initWarp = d_ptr->m_initWarp >= 0 ? d_ptr->m_initWarp : LST_CACHE_NONE;
+
+    // String index and data
+    std::vector<uint32_t> stringIndex;
+    uint32_t stringDataSize = 0;
+    for (const std::string* str : writer.m_strings) {
+        stringIndex.push_back(stringDataSize);
+        stringIndex.push_back(str->size());
+        stringDataSize += str->size();
+    }
+
+    // Sections follow the header in layout order
+    uint32_t header[LST_CACHE_FIELD_COUNT] = {};
+    uint32_t offset = LST_CACHE_FIELD_COUNT * 4;
+    auto section = [&](LstCacheField offsetField, const std::vector<uint32_t>& words) {
+        header[offsetField] = offset;
+        offset += words.size() * 4;
+    };
+
+    header[LST_CACHE_FIELD_MAGIC] = LST_CACHE_MAGIC;
+    header[LST_CACHE_FIELD_VERSION] = LST_CACHE_VERSION;
+    header[LST_CACHE_FIELD_SOURCE_SIZE_LOW] = uint32_t(sourceSize);
+    header[LST_CACHE_FIELD_SOURCE_SIZE_HIGH] = uint32_t(sourceSize >> 32);
+    header[LST_CACHE_FIELD_STRING_COUNT] = writer.m_strings.size();
+    section(LST_CACHE_FIELD_STRING_INDEX_OFFSET, stringIndex);
+    header[LST_CACHE_FIELD_VARIABLE_COUNT] = writer.m_variables.size();
+    section(LST_CACHE_FIELD_VARIABLES_OFFSET, writer.m_variables);
+    header[LST_CACHE_FIELD_NODE_COUNT] = writer.m_nodes.size() / LST_CACHE_NODE_WORDS;
+    section(LST_CACHE_FIELD_NODES_OFFSET, writer.m_nodes);
+    header[LST_CACHE_FIELD_PARAM_COUNT] = writer.m_params.size();
+    section(LST_CACHE_FIELD_PARAMS_OFFSET, writer.m_params);
+    header[LST_CACHE_FIELD_WARP_COUNT] = writer.m_warps.size() / LST_CACHE_WARP_WORDS;
+    section(LST_CACHE_FIELD_WARPS_OFFSET, writer.m_warps);
+    header[LST_CACHE_FIELD_TEST_COUNT] = writer.m_tests.size() / LST_CACHE_TEST_WORDS;
+    section(LST_CACHE_FIELD_TESTS_OFFSET, writer.m_tests);
+    header[LST_CACHE_FIELD_STRING_DATA_OFFSET] = offset;
+    header[LST_CACHE_FIELD_STRING_DATA_SIZE] = stringDataSize;
+    header[LST_CACHE_FIELD_SUBROUTINE_FIRST] = subroutineFirst;
+    header[LST_CACHE_FIELD_SUBROUTINE_COUNT] = subroutines.size();
+    header[LST_CACHE_FIELD_INIT_WARP] = initWarp;
+
+    std::vector<uint8_t> data;
+    data.reserve(offset + stringDataSize);
+    ofnx::tools::DataStream ds(&data);
+    ds.setEndian(std::endian::little);
+
+    for (uint32_t value : header) {
+        ds << value;
+    }
+    for (const std::vector<uint32_t>* words : { &stringIndex, &writer.m_variables, &writer.m_nodes, &writer.m_params, &writer.m_warps, &writer.m_tests }) {
+        for (uint32_t value : *words) {
+            ds << value;
+        }
+    }
+    for (const std::string* str : writer.m_strings) {
+        ds.write(str->size(), reinterpret_cast<const uint8_t*>(str->data()));
+    }
+
+    std::fstream file(fileName, std::ios::binary | std::ios::out);
+    if (!file.is_open()) {
+        LOG_ERROR("Could not open file: {}", fileName);
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!file.good()) {
+        LOG_ERROR("Could not write file: {}", fileName);
+        return false;
+    }
+
+    return true;
+}
+
+bool Lst::loadCache(const std::string& fileName)
+{
+    d_ptr->clear();
+
+    ofnx::tools::RandomAccessFile file;
+    if (!file.open(fileName) || !file.map()) {
+        LOG_ERROR("Could not open file: {}", fileName);
+        return false;
+    }
+
+    if (!d_ptr->readCache(file.mappedData(), UINT64_MAX)) {
+        d_ptr->clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool Lst::loadLst(const std::string& fileName, const std::string& cacheFileName)
+{
+    std::error_code error;
+    uint64_t sourceSize = std::filesystem::file_size(fileName, error);
+    if (error) {
+        LOG_ERROR("Could not open file: {}", fileName);
+        return false;
+    }
+
+    // Cache is used only when not older than the source
+    auto sourceTime = std::filesystem::last_write_time(fileName, error);
+    auto cacheTime = std::filesystem::last_write_time(cacheFileName, error);
+    if (!error && cacheTime >= sourceTime) {
+        ofnx::tools::RandomAccessFile file;
+        if (file.open(cacheFileName) && file.map()) {
+            d_ptr->clear();
+            if (d_ptr->readCache(file.mappedData(), sourceSize)) {
+                return true;
+            }
+        }
+
+        LOG_WARN("Ignoring LST cache: {}", cacheFileName);
+    }
+
+    // Also drops what a failed cache read left
+    d_ptr->clear();
+    if (!parseLst(fileName)) {
+        return false;
+    }
+
+    if (!saveCache(cacheFileName, sourceSize)) {
+        LOG_WARN("Could not write LST cache: {}", cacheFileName);
+    }
+
+    return true;
+}
+
 const std::set<std::string>& Lst::getVariables() const
 {
     return d_ptr->m_listVariables;
@@ -616,13 +1655,103 @@ const std::set<std::string>& Lst::getVariables() const
 
 const Lst::InstructionBlock& Lst::getInitBlock(const std::string& warpName) const
 {
-    return d_ptr->m_listWarps[warpName].initBlock;
+    return getInitBlock(getWarpId(warpName));
 }
 
 const Lst::InstructionBlock& Lst::getTestBlock(
     const std::string& warpName, const int& testId) const
 {
-    return d_ptr->m_listWarps[warpName].testBlockList[testId];
+    return getTestBlock(getWarpId(warpName), testId);
+}
+
+int Lst::getWarpCount() const
+{
+    return d_ptr->m_listWarps.size();
+}
+
+int Lst::getWarpId(std::string_view warpName) const
+{
+    return d_ptr->findWarp(warpName);
+}
+
+const std::string& Lst::getWarpName(int warpId) const
+{
+    static const std::string empty;
+
+    const Warp* warp = d_ptr->findWarp(warpId);
+    if (!warp) {
+        return empty;
+    }
+
+    return warp->name;
+}
+
+const Lst::InstructionBlock& Lst::getInitBlock(int warpId) const
+{
+    static const InstructionBlock empty;
+
+    const Warp* warp = d_ptr->findWarp(warpId);
+    if (!warp) {
+        return empty;
+    }
+
+    return warp->initBlock;
+}
+
+const Lst::InstructionBlock& Lst::getTestBlock(int warpId, int testId) const
+{
+    static const InstructionBlock empty;
+
+    const Warp* warp = d_ptr->findWarp(warpId);
+    if (!warp || !warp->hasTest(testId)) {
+        return empty;
+    }
+
+    return warp->testBlockList[testId];
+}
+
+bool Lst::hasTestBlock(int warpId, int testId) const
+{
+    const Warp* warp = d_ptr->findWarp(warpId);
+    return warp && warp->hasTest(testId);
+}
+
+const std::string& Lst::getInitWarp() const
+{
+    return getWarpName(d_ptr->m_initWarp);
+}
+
+std::vector<std::string> Lst::getWarps() const
+{
+    std::vector<std::string> warps;
+    for (const Warp& warp : d_ptr->m_listWarps) {
+        warps.push_back(warp.name);
+    }
+
+    return warps;
+}
+
+std::vector<int> Lst::getTestIds(const std::string& warpName) const
+{
+    std::vector<int> testIds;
+
+    const Warp* warp = d_ptr->findWarp(getWarpId(warpName));
+    if (!warp) {
+        return testIds;
+    }
+
+    for (size_t testId = 0; testId < warp->testPresent.size(); ++testId) {
+        if (warp->testPresent[testId]) {
+            testIds.push_back(testId);
+        }
+    }
+
+    return testIds;
+}
+
+const std::map<std::string, Lst::Instruction>& Lst::getSubroutines() const
+{
+    return d_ptr->m_listSubroutines;
 }
 
 } // namespace ofnx::files
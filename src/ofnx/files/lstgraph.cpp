@@ -0,0 +1,214 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "ofnx/files/lstgraph.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <set>
+#include <unordered_map>
+
+#include "ofnx/files/lst.h"
+#include "ofnx/tools/log.h"
+
+namespace ofnx::files {
+
+/* PRIVATE */
+class LstGraph::Impl {
+    friend class LstGraph;
+
+public:
+    int internWarp(const std::string& name);
+    void scanBlock(const Lst& lst, const Lst::InstructionBlock& block, int from, int testId);
+
+private:
+    std::vector<std::string> m_warpNames;
+    std::unordered_map<std::string, int> m_warpIds;
+    std::vector<std::vector<Edge>> m_edges;
+
+    // Scan state
+    std::vector<Guard> m_guards;
+    std::set<std::string> m_activeSubroutines;
+};
+
+int LstGraph::Impl::internWarp(const std::string& name)
+{
+    auto [it, inserted] = m_warpIds.try_emplace(name, m_warpNames.size());
+    if (inserted) {
+        m_warpNames.push_back(name);
+        m_edges.emplace_back();
+    }
+
+    return it->second;
+}
+
+void LstGraph::Impl::scanBlock(const Lst& lst, const Lst::InstructionBlock& block, int from, int testId)
+{
+    for (const Lst::Instruction& instruction : block) {
+        if (instruction.name == "end" || instruction.name == "return") {
+            // Following instructions never run
+            break;
+        }
+
+        if (instruction.name == "gotowarp" && !instruction.params.empty()) {
+            int to = internWarp(instruction.params[0]);
+            m_edges[from].push_back({ from, to, testId, m_guards });
+        } else if (instruction.name == "ifand" || instruction.name == "ifor") {
+            m_guards.push_back({ instruction.name == "ifor", instruction.params });
+            scanBlock(lst, instruction.subInstructions, from, testId);
+            m_guards.pop_back();
+        } else if (instruction.name == "gosub" && !instruction.params.empty()) {
+            const std::string& label = instruction.params[0];
+            const auto& subroutines = lst.getSubroutines();
+
+            // Recursive calls add no new edge
+            auto subroutine = subroutines.find(label);
+            if (subroutine != subroutines.end() && m_activeSubroutines.insert(label).second) {
+                scanBlock(lst, subroutine->second.subInstructions, from, testId);
+                m_activeSubroutines.erase(label);
+            }
+        }
+    }
+}
+
+/* PUBLIC */
+LstGraph::LstGraph()
+{
+    d_ptr = new Impl;
+}
+
+LstGraph::~LstGraph()
+{
+    delete d_ptr;
+}
+
+bool LstGraph::build(const Lst& lst)
+{
+    clear();
+
+    int lstWarpCount = lst.getWarpCount();
+    for (int warpId = 0; warpId < lstWarpCount; ++warpId) {
+        d_ptr->internWarp(lst.getWarpName(warpId));
+    }
+
+    for (int warpId = 0; warpId < lstWarpCount; ++warpId) {
+        d_ptr->scanBlock(lst, lst.getInitBlock(warpId), warpId, -1);
+
+        for (int testId : lst.getTestIds(lst.getWarpName(warpId))) {
+            d_ptr->scanBlock(lst, lst.getTestBlock(warpId, testId), warpId, testId);
+        }
+    }
+
+    return true;
+}
+
+void LstGraph::clear()
+{
+    d_ptr->m_warpNames.clear();
+    d_ptr->m_warpIds.clear();
+    d_ptr->m_edges.clear();
+    d_ptr->m_guards.clear();
+    d_ptr->m_activeSubroutines.clear();
+}
+
+int LstGraph::warpCount() const
+{
+    return d_ptr->m_warpNames.size();
+}
+
+int LstGraph::warpId(std::string_view name) const
+{
+    auto it = d_ptr->m_warpIds.find(std::string(name));
+    if (it == d_ptr->m_warpIds.end()) {
+        return -1;
+    }
+
+    return it->second;
+}
+
+const std::string& LstGraph::warpName(int warpId) const
+{
+    static const std::string empty;
+    if (warpId < 0 || warpId >= d_ptr->m_warpNames.size()) {
+        return empty;
+    }
+
+    return d_ptr->m_warpNames[warpId];
+}
+
+std::span<const LstGraph::Edge> LstGraph::edges(int warpId) const
+{
+    if (warpId < 0 || warpId >= d_ptr->m_edges.size()) {
+        return {};
+    }
+
+    return d_ptr->m_edges[warpId];
+}
+
+std::vector<LstGraph::Reach> LstGraph::reachable(int warpId, int maxClicks) const
+{
+    std::vector<Reach> result;
+    if (warpId < 0 || warpId >= d_ptr->m_edges.size() || maxClicks < 0) {
+        return result;
+    }
+
+    // 0-1 BFS: init block edges are free, test edges cost a click
+    std::vector<int> clicks(d_ptr->m_edges.size(), std::numeric_limits<int>::max());
+    std::deque<int> queue;
+    clicks[warpId] = 0;
+    queue.push_back(warpId);
+
+    while (!queue.empty()) {
+        int from = queue.front();
+        queue.pop_front();
+
+        for (const Edge& edge : d_ptr->m_edges[from]) {
+            int cost = edge.testId < 0 ? 0 : 1;
+            int total = clicks[from] + cost;
+            if (total > maxClicks || total >= clicks[edge.to]) {
+                continue;
+            }
+
+            clicks[edge.to] = total;
+            if (cost == 0) {
+                queue.push_front(edge.to);
+            } else {
+                queue.push_back(edge.to);
+            }
+        }
+    }
+
+    for (int to = 0; to < clicks.size(); ++to) {
+        if (to != warpId && clicks[to] <= maxClicks) {
+            result.push_back({ to, clicks[to] });
+        }
+    }
+
+    std::stable_sort(result.begin(), result.end(), [](const Reach& a, const Reach& b) { return a.clicks < b.clicks; });
+
+    return result;
+}
+
+} // namespace ofnx::files
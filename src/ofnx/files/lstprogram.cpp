@@ -0,0 +1,434 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "ofnx/files/lstprogram.h"
+
+#include <array>
+#include <charconv>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ofnx/files/lst.h"
+#include "ofnx/tools/log.h"
+
+namespace ofnx::files {
+
+constexpr std::array<std::pair<std::string_view, LstProgram::Opcode>, 21> NAMED_OPCODES { {
+    { "end", LstProgram::Opcode::END },
+    { "return", LstProgram::Opcode::RETURN },
+    { "gotowarp", LstProgram::Opcode::GOTOWARP },
+    { "playmusique", LstProgram::Opcode::PLAYMUSIQUE },
+    { "stopmusique", LstProgram::Opcode::STOPMUSIQUE },
+    { "playsound", LstProgram::Opcode::PLAYSOUND },
+    { "stopsound", LstProgram::Opcode::STOPSOUND },
+    { "playsound3d", LstProgram::Opcode::PLAYSOUND3D },
+    { "stopsound3d", LstProgram::Opcode::STOPSOUND3D },
+    { "setcursor", LstProgram::Opcode::SETCURSOR },
+    { "setcursordefault", LstProgram::Opcode::SETCURSORDEFAULT },
+    { "hidecursor", LstProgram::Opcode::HIDECURSOR },
+    { "setangle", LstProgram::Opcode::SETANGLE },
+    { "interpolangle", LstProgram::Opcode::INTERPOLANGLE },
+    { "anglexmax", LstProgram::Opcode::ANGLEXMAX },
+    { "angleymax", LstProgram::Opcode::ANGLEYMAX },
+    { "fade", LstProgram::Opcode::FADE },
+    { "lockkey", LstProgram::Opcode::LOCKKEY },
+    { "resetlockkey", LstProgram::Opcode::RESETLOCKKEY },
+    { "setzoom", LstProgram::Opcode::SETZOOM },
+    { "not", LstProgram::Opcode::NOT },
+} };
+
+/* PRIVATE */
+class LstProgram::Impl {
+    friend class LstProgram;
+
+public:
+    struct Interner {
+        struct Hash {
+            using is_transparent = void;
+
+            size_t operator()(std::string_view name) const
+            {
+                return std::hash<std::string_view> {}(name);
+            }
+        };
+
+        std::vector<std::string> names;
+        std::unordered_map<std::string, int, Hash, std::equal_to<>> ids;
+
+        int intern(std::string_view name);
+        int find(std::string_view name) const;
+        const std::string& name(int id) const;
+        void clear();
+    };
+
+    struct WarpBlocks {
+        int32_t initBlock = -1;
+        std::vector<int32_t> testBlocks;
+    };
+
+public:
+    size_t addOp(Opcode opcode, const std::vector<std::string>& params, int32_t target = -1);
+    bool emit(const Lst::Instruction& instruction);
+    bool emitBlock(const Lst::InstructionBlock& block, Opcode terminator);
+
+private:
+    std::vector<Op> m_code;
+    std::vector<Operand> m_operands;
+
+    Interner m_variables;
+    Interner m_warps;
+    Interner m_strings;
+    Interner m_subroutineNames;
+
+    std::vector<WarpBlocks> m_warpBlocks;
+    std::vector<int32_t> m_subroutines;
+    std::vector<std::pair<size_t, int>> m_gosubFixups; // Op index, subroutine name id
+    int m_initWarp = -1;
+};
+
+int LstProgram::Impl::Interner::intern(std::string_view name)
+{
+    auto it = ids.find(name);
+    if (it != ids.end()) {
+        return it->second;
+    }
+
+    int id = names.size();
+    names.emplace_back(name);
+    ids.emplace(names.back(), id);
+
+    return id;
+}
+
+int LstProgram::Impl::Interner::find(std::string_view name) const
+{
+    auto it = ids.find(name);
+    if (it == ids.end()) {
+        return -1;
+    }
+
+    return it->second;
+}
+
+const std::string& LstProgram::Impl::Interner::name(int id) const
+{
+    static const std::string empty;
+    if (id < 0 || id >= names.size()) {
+        return empty;
+    }
+
+    return names[id];
+}
+
+void LstProgram::Impl::Interner::clear()
+{
+    names.clear();
+    ids.clear();
+}
+
+size_t LstProgram::Impl::addOp(Opcode opcode, const std::vector<std::string>& params, int32_t target)
+{
+    Op op;
+    op.opcode = opcode;
+    op.operandCount = std::min<size_t>(params.size(), UINT16_MAX);
+    op.operandOffset = m_operands.size();
+    op.target = target;
+
+    for (size_t i = 0; i < op.operandCount; ++i) {
+        const std::string& param = params[i];
+
+        Operand operand;
+        std::from_chars(param.data(), param.data() + param.size(), operand.integer);
+        std::from_chars(param.data(), param.data() + param.size(), operand.number);
+        operand.string = m_strings.intern(param);
+
+        m_operands.push_back(operand);
+    }
+
+    m_code.push_back(op);
+
+    return m_code.size() - 1;
+}
+
+bool LstProgram::Impl::emit(const Lst::Instruction& instruction)
+{
+    const std::string& name = instruction.name;
+
+    if (name == "ifand" || name == "ifor") {
+        size_t opIndex = addOp(name == "ifand" ? Opcode::IF_AND : Opcode::IF_OR, instruction.params);
+        for (size_t i = 0; i < instruction.params.size(); ++i) {
+            m_operands[m_code[opIndex].operandOffset + i].integer = m_variables.intern(instruction.params[i]);
+        }
+
+        for (const Lst::Instruction& subInstruction : instruction.subInstructions) {
+            if (!emit(subInstruction)) {
+                return false;
+            }
+        }
+
+        // Guarded instructions are skipped by jumping past them
+        m_code[opIndex].target = m_code.size();
+        return true;
+    }
+
+    if (name == "plugin") {
+        for (const Lst::Instruction& subInstruction : instruction.subInstructions) {
+            addOp(Opcode::PLUGIN_CALL, subInstruction.params, m_strings.intern(subInstruction.name));
+        }
+        return true;
+    }
+
+    if (name == "set") {
+        size_t opIndex = addOp(Opcode::SET, instruction.params);
+        if (!instruction.params.empty()) {
+            m_operands[m_code[opIndex].operandOffset].integer = m_variables.intern(instruction.params[0]);
+        }
+        return true;
+    }
+
+    if (name == "gosub") {
+        size_t opIndex = addOp(Opcode::GOSUB, instruction.params);
+        if (!instruction.params.empty()) {
+            m_gosubFixups.push_back({ opIndex, m_subroutineNames.intern(instruction.params[0]) });
+        }
+        return true;
+    }
+
+    if (name == "gotowarp") {
+        int warpId = instruction.params.empty() ? -1 : m_warps.intern(instruction.params[0]);
+        addOp(Opcode::GOTOWARP, instruction.params, warpId);
+        return true;
+    }
+
+    for (const auto& [opcodeName, opcode] : NAMED_OPCODES) {
+        if (name == opcodeName) {
+            addOp(opcode, instruction.params);
+            return true;
+        }
+    }
+
+    LOG_ERROR("Unknown instruction: {}", name);
+    return false;
+}
+
+bool LstProgram::Impl::emitBlock(const Lst::InstructionBlock& block, Opcode terminator)
+{
+    for (const Lst::Instruction& instruction : block) {
+        if (!emit(instruction)) {
+            return false;
+        }
+    }
+
+    addOp(terminator, {});
+
+    return true;
+}
+
+/* PUBLIC */
+LstProgram::LstProgram()
+{
+    d_ptr = new Impl;
+}
+
+LstProgram::~LstProgram()
+{
+    delete d_ptr;
+}
+
+bool LstProgram::compile(const Lst& lst)
+{
+    clear();
+
+    for (const std::string& variable : lst.getVariables()) {
+        d_ptr->m_variables.intern(variable);
+    }
+
+    // Warp ids match Lst ones, warps only referenced by gotowarp are added after them
+    int warpCount = lst.getWarpCount();
+    for (int warpId = 0; warpId < warpCount; ++warpId) {
+        d_ptr->m_warps.intern(lst.getWarpName(warpId));
+    }
+
+    // Subroutines
+    for (const auto& [name, subroutine] : lst.getSubroutines()) {
+        int id = d_ptr->m_subroutineNames.intern(name);
+        d_ptr->m_subroutines.resize(d_ptr->m_subroutineNames.names.size(), -1);
+        d_ptr->m_subroutines[id] = d_ptr->m_code.size();
+
+        if (!d_ptr->emitBlock(subroutine.subInstructions, Opcode::RETURN)) {
+            LOG_ERROR("Unable to compile subroutine: {}", name);
+            clear();
+            return false;
+        }
+    }
+
+    // Warp blocks
+    d_ptr->m_warpBlocks.resize(warpCount);
+    for (int warpId = 0; warpId < warpCount; ++warpId) {
+        Impl::WarpBlocks& blocks = d_ptr->m_warpBlocks[warpId];
+        const std::string& warpName = lst.getWarpName(warpId);
+
+        const Lst::InstructionBlock& initBlock = lst.getInitBlock(warpId);
+        if (!initBlock.empty()) {
+            blocks.initBlock = d_ptr->m_code.size();
+            if (!d_ptr->emitBlock(initBlock, Opcode::END)) {
+                LOG_ERROR("Unable to compile init block: {}", warpName);
+                clear();
+                return false;
+            }
+        }
+
+        for (int testId : lst.getTestIds(warpName)) {
+            if (testId >= blocks.testBlocks.size()) {
+                blocks.testBlocks.resize(testId + 1, -1);
+            }
+
+            blocks.testBlocks[testId] = d_ptr->m_code.size();
+            if (!d_ptr->emitBlock(lst.getTestBlock(warpId, testId), Opcode::END)) {
+                LOG_ERROR("Unable to compile test block: {} {}", warpName, testId);
+                clear();
+                return false;
+            }
+        }
+    }
+
+    // Warps only referenced by gotowarp have no blocks
+    d_ptr->m_warpBlocks.resize(d_ptr->m_warps.names.size());
+    d_ptr->m_subroutines.resize(d_ptr->m_subroutineNames.names.size(), -1);
+
+    for (const auto& [opIndex, nameId] : d_ptr->m_gosubFixups) {
+        d_ptr->m_code[opIndex].target = d_ptr->m_subroutines[nameId];
+    }
+    d_ptr->m_gosubFixups.clear();
+
+    for (size_t id = 0; id < d_ptr->m_subroutines.size(); ++id) {
+        if (d_ptr->m_subroutines[id] < 0) {
+            LOG_WARN("Unknown subroutine: {}", d_ptr->m_subroutineNames.name(id));
+        }
+    }
+
+    d_ptr->m_initWarp = d_ptr->m_warps.find(lst.getInitWarp());
+
+    return true;
+}
+
+void LstProgram::clear()
+{
+    d_ptr->m_code.clear();
+    d_ptr->m_operands.clear();
+    d_ptr->m_variables.clear();
+    d_ptr->m_warps.clear();
+    d_ptr->m_strings.clear();
+    d_ptr->m_subroutineNames.clear();
+    d_ptr->m_warpBlocks.clear();
+    d_ptr->m_subroutines.clear();
+    d_ptr->m_gosubFixups.clear();
+    d_ptr->m_initWarp = -1;
+}
+
+std::span<const LstProgram::Op> LstProgram::code() const
+{
+    return d_ptr->m_code;
+}
+
+std::span<const LstProgram::Operand> LstProgram::operands(const Op& op) const
+{
+    return std::span<const Operand>(d_ptr->m_operands).subspan(op.operandOffset, op.operandCount);
+}
+
+int LstProgram::variableCount() const
+{
+    return d_ptr->m_variables.names.size();
+}
+
+int LstProgram::variableId(std::string_view name) const
+{
+    return d_ptr->m_variables.find(name);
+}
+
+const std::string& LstProgram::variableName(int id) const
+{
+    return d_ptr->m_variables.name(id);
+}
+
+int LstProgram::warpCount() const
+{
+    return d_ptr->m_warps.names.size();
+}
+
+int LstProgram::warpId(std::string_view name) const
+{
+    return d_ptr->m_warps.find(name);
+}
+
+const std::string& LstProgram::warpName(int id) const
+{
+    return d_ptr->m_warps.name(id);
+}
+
+int LstProgram::initWarp() const
+{
+    return d_ptr->m_initWarp;
+}
+
+const std::string& LstProgram::string(uint32_t id) const
+{
+    return d_ptr->m_strings.name(id);
+}
+
+int LstProgram::initBlock(int warpId) const
+{
+    if (warpId < 0 || warpId >= d_ptr->m_warpBlocks.size()) {
+        return -1;
+    }
+
+    return d_ptr->m_warpBlocks[warpId].initBlock;
+}
+
+int LstProgram::testBlock(int warpId, int testId) const
+{
+    if (warpId < 0 || warpId >= d_ptr->m_warpBlocks.size()) {
+        return -1;
+    }
+
+    const std::vector<int32_t>& testBlocks = d_ptr->m_warpBlocks[warpId].testBlocks;
+    if (testId < 0 || testId >= testBlocks.size()) {
+        return -1;
+    }
+
+    return testBlocks[testId];
+}
+
+int LstProgram::subroutine(std::string_view name) const
+{
+    int id = d_ptr->m_subroutineNames.find(name);
+    if (id < 0) {
+        return -1;
+    }
+
+    return d_ptr->m_subroutines[id];
+}
+
+} // namespace ofnx::files
@@ -0,0 +1,288 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "ofnx/files/lstvm.h"
+
+#include <array>
+#include <vector>
+
+#include "ofnx/tools/log.h"
+
+namespace ofnx::files {
+
+constexpr size_t LST_VM_MAX_CALL_DEPTH = 64;
+constexpr size_t LST_VM_MAX_RUN_DEPTH = 8; // Runs nested from handlers
+
+/* PRIVATE */
+class LstVm::Impl {
+    friend class LstVm;
+
+public:
+    using Op = LstProgram::Op;
+    using Exec = int (Impl::*)(int pc, const Op& op);
+
+    // Each returns the next program counter, -1 to stop
+    int execEnd(int pc, const Op& op);
+    int execReturn(int pc, const Op& op);
+    int execSet(int pc, const Op& op);
+    int execIfAnd(int pc, const Op& op);
+    int execIfOr(int pc, const Op& op);
+    int execGosub(int pc, const Op& op);
+    int execHost(int pc, const Op& op);
+
+    bool isSet(int id) const;
+
+    static constexpr std::array<Exec, size_t(LstProgram::Opcode::COUNT)> DISPATCH = [] {
+        std::array<Exec, size_t(LstProgram::Opcode::COUNT)> table;
+        table.fill(&Impl::execHost);
+        table[size_t(LstProgram::Opcode::END)] = &Impl::execEnd;
+        table[size_t(LstProgram::Opcode::RETURN)] = &Impl::execReturn;
+        table[size_t(LstProgram::Opcode::SET)] = &Impl::execSet;
+        table[size_t(LstProgram::Opcode::IF_AND)] = &Impl::execIfAnd;
+        table[size_t(LstProgram::Opcode::IF_OR)] = &Impl::execIfOr;
+        table[size_t(LstProgram::Opcode::GOSUB)] = &Impl::execGosub;
+        return table;
+    }();
+
+private:
+    const LstProgram* m_program = nullptr;
+    std::array<Handler, size_t(LstProgram::Opcode::COUNT)> m_handlers;
+
+    std::vector<uint8_t> m_variables;
+    std::vector<int> m_callStack;
+    size_t m_callBase = 0;
+    size_t m_runDepth = 0;
+    bool m_stopped = false;
+};
+
+int LstVm::Impl::execEnd(int, const Op&)
+{
+    return -1;
+}
+
+int LstVm::Impl::execReturn(int, const Op&)
+{
+    if (m_callStack.size() <= m_callBase) {
+        return -1;
+    }
+
+    int returnPc = m_callStack.back();
+    m_callStack.pop_back();
+
+    return returnPc;
+}
+
+int LstVm::Impl::execSet(int pc, const Op& op)
+{
+    std::span<const LstProgram::Operand> operands = m_program->operands(op);
+    if (!operands.empty()) {
+        int id = operands[0].integer;
+        if (id >= 0 && id < m_variables.size()) {
+            m_variables[id] = operands.size() > 1 && operands[1].integer != 0;
+        }
+    }
+
+    return pc + 1;
+}
+
+int LstVm::Impl::execIfAnd(int pc, const Op& op)
+{
+    for (const LstProgram::Operand& operand : m_program->operands(op)) {
+        if (!isSet(operand.integer)) {
+            return op.target;
+        }
+    }
+
+    return pc + 1;
+}
+
+int LstVm::Impl::execIfOr(int pc, const Op& op)
+{
+    for (const LstProgram::Operand& operand : m_program->operands(op)) {
+        if (isSet(operand.integer)) {
+            return pc + 1;
+        }
+    }
+
+    return op.target;
+}
+
+int LstVm::Impl::execGosub(int pc, const Op& op)
+{
+    if (op.target < 0) {
+        return pc + 1;
+    }
+
+    if (m_callStack.size() - m_callBase >= LST_VM_MAX_CALL_DEPTH) {
+        LOG_ERROR("Subroutine call depth exceeded");
+        return -1;
+    }
+
+    m_callStack.push_back(pc + 1);
+
+    return op.target;
+}
+
+int LstVm::Impl::execHost(int pc, const Op& op)
+{
+    const Handler& handler = m_handlers[size_t(op.opcode)];
+    if (handler) {
+        handler(op, m_program->operands(op));
+    }
+
+    return m_stopped ? -1 : pc + 1;
+}
+
+bool LstVm::Impl::isSet(int id) const
+{
+    return id >= 0 && id < m_variables.size() && m_variables[id];
+}
+
+/* PUBLIC */
+LstVm::LstVm()
+{
+    d_ptr = new Impl;
+}
+
+LstVm::~LstVm()
+{
+    delete d_ptr;
+}
+
+void LstVm::setProgram(const LstProgram* program)
+{
+    d_ptr->m_program = program;
+    d_ptr->m_variables.assign(program ? program->variableCount() : 0, 0);
+    d_ptr->m_callStack.clear();
+    d_ptr->m_callStack.reserve(LST_VM_MAX_CALL_DEPTH * LST_VM_MAX_RUN_DEPTH);
+}
+
+void LstVm::setHandler(LstProgram::Opcode opcode, Handler handler)
+{
+    if (opcode >= LstProgram::Opcode::COUNT) {
+        LOG_ERROR("Invalid opcode");
+        return;
+    }
+
+    d_ptr->m_handlers[size_t(opcode)] = std::move(handler);
+}
+
+bool LstVm::variable(int id) const
+{
+    return d_ptr->isSet(id);
+}
+
+void LstVm::setVariable(int id, bool value)
+{
+    if (id < 0 || id >= d_ptr->m_variables.size()) {
+        LOG_ERROR("Invalid variable id: {}", id);
+        return;
+    }
+
+    d_ptr->m_variables[id] = value;
+}
+
+std::span<const uint8_t> LstVm::variables() const
+{
+    return d_ptr->m_variables;
+}
+
+bool LstVm::runInitBlock(int warpId)
+{
+    if (!d_ptr->m_program) {
+        LOG_ERROR("No program set");
+        return false;
+    }
+
+    int entry = d_ptr->m_program->initBlock(warpId);
+    if (entry < 0) {
+        return false;
+    }
+
+    return run(entry);
+}
+
+bool LstVm::runTestBlock(int warpId, int testId)
+{
+    if (!d_ptr->m_program) {
+        LOG_ERROR("No program set");
+        return false;
+    }
+
+    int entry = d_ptr->m_program->testBlock(warpId, testId);
+    if (entry < 0) {
+        return false;
+    }
+
+    return run(entry);
+}
+
+bool LstVm::run(int entry)
+{
+    if (!d_ptr->m_program) {
+        LOG_ERROR("No program set");
+        return false;
+    }
+
+    if (d_ptr->m_runDepth >= LST_VM_MAX_RUN_DEPTH) {
+        LOG_ERROR("Nested run depth exceeded");
+        return false;
+    }
+
+    std::span<const LstProgram::Op> code = d_ptr->m_program->code();
+
+    // Handlers may run other blocks, keep the caller's call frames and stop request untouched
+    size_t previousCallBase = d_ptr->m_callBase;
+    bool previousStopped = d_ptr->m_stopped;
+    d_ptr->m_callBase = d_ptr->m_callStack.size();
+    d_ptr->m_stopped = false;
+    ++d_ptr->m_runDepth;
+
+    bool success = true;
+    int pc = entry;
+    while (pc >= 0) {
+        if (pc >= code.size()) {
+            LOG_ERROR("Program counter out of range: {}", pc);
+            success = false;
+            break;
+        }
+
+        const LstProgram::Op& op = code[pc];
+        pc = (d_ptr->*Impl::DISPATCH[size_t(op.opcode)])(pc, op);
+    }
+
+    d_ptr->m_callStack.resize(d_ptr->m_callBase);
+    d_ptr->m_callBase = previousCallBase;
+    d_ptr->m_stopped = d_ptr->m_runDepth > 1 && (previousStopped || d_ptr->m_stopped);
+    --d_ptr->m_runDepth;
+
+    return success;
+}
+
+void LstVm::stop()
+{
+    d_ptr->m_stopped = true;
+}
+
+} // namespace ofnx::files
@@ -24,23 +24,44 @@ SOFTWARE.
 
 #include "ofnx/files/pak.h"
 
+#include <algorithm>
+#include <bit>
 #include <bitset>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <vector>
 
+#include "ofnx/files/pakcache.h"
 #include "ofnx/tools/datastream.h"
 #include "ofnx/tools/log.h"
+#include "ofnx/tools/randomaccessfile.h"
 
 namespace ofnx::files {
 
 /* PRIVATE */
+constexpr size_t PAK3_MAX_LITERAL = 128;
+constexpr size_t PAK3_MIN_MATCH = 3;
+constexpr size_t PAK3_MAX_MATCH = 64;
+constexpr size_t PAK3_SHORT_DISTANCE = 0x100;
+constexpr size_t PAK3_WINDOW = 0x10000;
+constexpr int PAK3_HASH_BITS = 16;
+constexpr uint32_t PAK3_NO_POS = 0xFFFFFFFF;
+
+constexpr size_t PAK_HEADER_SIZE = 8;
+constexpr size_t PAK_ENTRY_HEADER_SIZE = 28;
+
 struct PakFile {
     std::string fileName;
     uint32_t compressedSize;
     uint32_t uncompressedSize;
     uint32_t compressionLevel;
 
+    // Entries read from the archive are loaded on demand from dataOffset,
+    // entries added through addFile keep their data in memory
+    uint64_t dataOffset = 0;
+    bool inMemory = false;
     std::vector<uint8_t> compressedData;
 };
 
@@ -48,13 +69,66 @@ class Pak::Impl {
     friend class Pak;
 
 public:
+    struct Match {
+        size_t length = 0;
+        size_t distance = 0;
+    };
+
     static void uncompressPakData3(const std::vector<uint8_t>& dataIn, std::vector<uint8_t>& dataOut);
+    static void compressPakData3(const std::vector<uint8_t>& dataIn, std::vector<uint8_t>& dataOut, CompressionEffort effort);
+
+    static std::string cacheFileName(const std::string& pakFileName);
+    static uint64_t cacheStamp(const std::string& pakFileName);
+
+    bool checkIndex(int index) const;
+    bool readCompressed(const PakFile& subFile, std::vector<uint8_t>& dataOut) const;
+    bool uncompressFile(int index, std::vector<uint8_t>& dataOut) const;
+    bool isCached() const;
 
 private:
-    std::fstream filePak;
+    ofnx::tools::RandomAccessFile filePak; // Positional reads, safe to share between threads
+    std::string filePakName;
     std::vector<PakFile> listFile;
+    uint8_t header[4] = { 0, 0, 0, 0 };
+
+    uint32_t cacheArchive = 0; // PakCache archive identifier (0 if not registered)
 };
 
+inline uint32_t hashPak3(const uint8_t* data)
+{
+    uint32_t value = data[0] | (data[1] << 8) | (data[2] << 16);
+    return (value * 2654435761u) >> (32 - PAK3_HASH_BITS);
+}
+
+inline size_t matchLengthPak3(const uint8_t* a, const uint8_t* b, size_t maxLength)
+{
+    // Compare 8 bytes at a time, the first differing byte is found from the XOR
+    size_t length = 0;
+    while (length + 8 <= maxLength) {
+        uint64_t valueA;
+        uint64_t valueB;
+        std::memcpy(&valueA, a + length, 8);
+        std::memcpy(&valueB, b + length, 8);
+
+        uint64_t diff = valueA ^ valueB;
+        if (diff != 0) {
+            if constexpr (std::endian::native == std::endian::little) {
+                return length + std::countr_zero(diff) / 8;
+            } else {
+                return length + std::countl_zero(diff) / 8;
+            }
+        }
+
+        length += 8;
+    }
+
+    while (length < maxLength && a[length] == b[length]) {
+        ++length;
+    }
+
+    return length;
+}
+
 void Pak::Impl::uncompressPakData3(const std::vector<uint8_t>& dataIn, std::vector<uint8_t>& dataOut)
 {
     size_t idxIn = 0;
@@ -97,6 +171,228 @@ void Pak::Impl::uncompressPakData3(const std::vector<uint8_t>& dataIn, std::vect
     }
 }
 
+void Pak::Impl::compressPakData3(const std::vector<uint8_t>& dataIn, std::vector<uint8_t>& dataOut, CompressionEffort effort)
+{
+    /*
+     * Produces the token stream read by uncompressPakData3:
+     *      0nnnnnnn                    => copy of n + 1 literal bytes
+     *      11nnnnnn dddddddd           => copy of n + 1 bytes from d + 1 bytes back
+     *      10nnnnnn dddddddd dddddddd  => same with a 2 bytes big endian distance
+     *
+     * Matches are found through hash chains over 3 bytes prefixes, the effort
+     * level selects the chain depth and whether lazy matching is used.
+     */
+    int maxChain;
+    bool lazy;
+    switch (effort) {
+    case CompressionEffort::FAST:
+        maxChain = 4;
+        lazy = false;
+        break;
+    case CompressionEffort::BEST:
+        maxChain = 512;
+        lazy = true;
+        break;
+    case CompressionEffort::NORMAL:
+    default:
+        maxChain = 32;
+        lazy = true;
+        break;
+    }
+
+    const uint8_t* data = dataIn.data();
+    const size_t size = dataIn.size();
+
+    dataOut.clear();
+    dataOut.reserve(size + size / PAK3_MAX_LITERAL + 1);
+
+    std::vector<uint32_t> head(size_t(1) << PAK3_HASH_BITS, PAK3_NO_POS);
+    std::vector<uint32_t> prev(std::min(size, PAK3_WINDOW), PAK3_NO_POS);
+
+    auto insert = [&](size_t pos) {
+        if (pos + PAK3_MIN_MATCH > size) {
+            return;
+        }
+
+        uint32_t hash = hashPak3(data + pos);
+        prev[pos & (PAK3_WINDOW - 1)] = head[hash];
+        head[hash] = pos;
+    };
+
+    auto findMatch = [&](size_t pos) {
+        Match best;
+
+        size_t maxLength = std::min(PAK3_MAX_MATCH, size - pos);
+        if (maxLength < PAK3_MIN_MATCH) {
+            return best;
+        }
+
+        uint32_t candidate = head[hashPak3(data + pos)];
+        for (int chain = 0; candidate != PAK3_NO_POS && chain < maxChain; ++chain) {
+            size_t distance = pos - candidate;
+            if (distance > PAK3_WINDOW) {
+                break;
+            }
+
+            if (data[candidate + best.length] == data[pos + best.length]) {
+                size_t length = matchLengthPak3(data + candidate, data + pos, maxLength);
+
+                // Long distances cost an extra byte, a 3 bytes match would not save anything
+                size_t minLength = distance > PAK3_SHORT_DISTANCE ? PAK3_MIN_MATCH + 1 : PAK3_MIN_MATCH;
+                if (length > best.length && length >= minLength) {
+                    best.length = length;
+                    best.distance = distance;
+
+                    if (length == maxLength) {
+                        break;
+                    }
+                }
+            }
+
+            candidate = prev[candidate & (PAK3_WINDOW - 1)];
+        }
+
+        return best;
+    };
+
+    auto flushLiterals = [&](size_t start, size_t end) {
+        while (start < end) {
+            size_t count = std::min(PAK3_MAX_LITERAL, end - start);
+            dataOut.push_back(count - 1);
+            dataOut.insert(dataOut.end(), data + start, data + start + count);
+            start += count;
+        }
+    };
+
+    size_t pos = 0;
+    size_t literalStart = 0;
+    bool hasNextMatch = false;
+    Match nextMatch;
+    while (pos < size) {
+        Match match = hasNextMatch ? nextMatch : findMatch(pos);
+        hasNextMatch = false;
+        insert(pos);
+
+        if (match.length == 0) {
+            ++pos;
+            continue;
+        }
+
+        // Lazy matching: keep current byte as literal if next position gives a longer match
+        if (lazy && match.length < PAK3_MAX_MATCH && pos + 1 < size) {
+            nextMatch = findMatch(pos + 1);
+            if (nextMatch.length > match.length) {
+                hasNextMatch = true;
+                ++pos;
+                continue;
+            }
+        }
+
+        flushLiterals(literalStart, pos);
+
+        size_t distance = match.distance - 1;
+        if (match.distance <= PAK3_SHORT_DISTANCE) {
+            dataOut.push_back(0xC0 | (match.length - 1));
+            dataOut.push_back(distance);
+        } else {
+            dataOut.push_back(0x80 | (match.length - 1));
+            dataOut.push_back(distance >> 8);
+            dataOut.push_back(distance & 0xFF);
+        }
+
+        for (size_t i = 1; i < match.length; ++i) {
+            insert(pos + i);
+        }
+
+        pos += match.length;
+        literalStart = pos;
+    }
+
+    flushLiterals(literalStart, size);
+}
+
+std::string Pak::Impl::cacheFileName(const std::string& pakFileName)
+{
+    std::error_code error;
+    std::filesystem::path path = std::filesystem::weakly_canonical(pakFileName, error);
+    if (error) {
+        return pakFileName;
+    }
+
+    return path.string();
+}
+
+uint64_t Pak::Impl::cacheStamp(const std::string& pakFileName)
+{
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(pakFileName, error);
+    auto writeTime = std::filesystem::last_write_time(pakFileName, error);
+
+    return uint64_t(writeTime.time_since_epoch().count()) ^ (size * 0x9E3779B97F4A7C15ull);
+}
+
+bool Pak::Impl::checkIndex(int index) const
+{
+    if (index < 0 || index >= listFile.size()) {
+        LOG_ERROR("Index out of range");
+        return false;
+    }
+
+    if (!filePak.isOpen()) {
+        LOG_ERROR("File not open");
+        return false;
+    }
+
+    return true;
+}
+
+bool Pak::Impl::readCompressed(const PakFile& subFile, std::vector<uint8_t>& dataOut) const
+{
+    dataOut.resize(subFile.compressedSize);
+    if (!filePak.read(subFile.dataOffset, subFile.compressedSize, dataOut.data())) {
+        LOG_ERROR("Could not read file data: {}", subFile.fileName);
+        return false;
+    }
+
+    return true;
+}
+
+bool Pak::Impl::uncompressFile(int index, std::vector<uint8_t>& dataOut) const
+{
+    const PakFile& subFile = listFile[index];
+
+    std::vector<uint8_t> compressedData;
+    if (!subFile.inMemory && !readCompressed(subFile, compressedData)) {
+        return false;
+    }
+
+    dataOut.reserve(subFile.uncompressedSize);
+    switch (subFile.compressionLevel) {
+    case 3:
+        uncompressPakData3(subFile.inMemory ? subFile.compressedData : compressedData, dataOut);
+        break;
+
+    default:
+        LOG_ERROR("Compression not yet known");
+        break;
+    }
+
+    if (dataOut.size() != subFile.uncompressedSize) {
+        LOG_ERROR("Uncompressed size does not match");
+        LOG_ERROR("    Expected: {}", subFile.uncompressedSize);
+        LOG_ERROR("    Actual: {}", dataOut.size());
+
+        return false;
+    }
+
+    return true;
+}
+
+bool Pak::Impl::isCached() const
+{
+    return cacheArchive != 0 && PakCache::instance().budget() > 0;
+}
+
 /* PUBLIC */
 Pak::Pak()
 {
@@ -110,44 +406,64 @@ Pak::~Pak()
 
 bool Pak::open(const std::string& pakFileName)
 {
-    d_ptr->filePak.open(pakFileName, std::ios_base::in | std::ios_base::binary);
-    if (!d_ptr->filePak.is_open()) {
+    if (!d_ptr->filePak.open(pakFileName)) {
         LOG_ERROR("Could not open file: {}", pakFileName);
         return false;
     }
 
-    ofnx::tools::DataStream ds(&d_ptr->filePak);
-    ds.setEndian(std::endian::little);
+    std::vector<uint8_t> header(PAK_HEADER_SIZE);
+    if (!d_ptr->filePak.read(0, PAK_HEADER_SIZE, header.data())) {
+        LOG_ERROR("Invalid PAK header");
+        d_ptr->filePak.close();
+        return false;
+    }
 
-    uint8_t header[5] = { 0, 0, 0, 0, 0 };
-    ds.read(4, header);
+    ofnx::tools::DataStream dsHeader(&header);
+    dsHeader.setEndian(std::endian::little);
+
+    dsHeader.read(4, d_ptr->header);
 
     uint32_t fileSize;
-    ds >> fileSize;
+    dsHeader >> fileSize;
+
+    uint64_t endOffset = std::min<uint64_t>(fileSize, d_ptr->filePak.size());
 
+    // Only entry headers are read here, data is read when needed
     d_ptr->listFile.clear();
-    while (!d_ptr->filePak.eof()) {
+    uint64_t offset = PAK_HEADER_SIZE;
+    std::vector<uint8_t> entryHeader(PAK_ENTRY_HEADER_SIZE);
+    while (offset + PAK_ENTRY_HEADER_SIZE <= endOffset) {
+        if (!d_ptr->filePak.read(offset, PAK_ENTRY_HEADER_SIZE, entryHeader.data())) {
+            break;
+        }
+
+        ofnx::tools::DataStream ds(&entryHeader);
+        ds.setEndian(std::endian::little);
+
         PakFile subFile;
 
         uint8_t compFileName[16]; // Compressed file name
         ds.read(16, compFileName);
-        subFile.fileName = std::string((char*)compFileName);
+        subFile.fileName = std::string((char*)compFileName, std::find(compFileName, compFileName + 16, 0) - compFileName);
 
         ds >> subFile.compressionLevel;
         ds >> subFile.compressedSize;
         ds >> subFile.uncompressedSize;
 
-        subFile.compressedData.resize(subFile.compressedSize, 0x00);
-        ds.read(subFile.compressedSize, subFile.compressedData.data());
-
-        d_ptr->listFile.push_back(subFile);
-
-        // Check if we are at the end of the file
-        if (d_ptr->filePak.tellg() == fileSize) {
+        subFile.dataOffset = offset + PAK_ENTRY_HEADER_SIZE;
+        if (subFile.dataOffset + subFile.compressedSize > endOffset) {
+            LOG_ERROR("Truncated file data: {}", subFile.fileName);
             break;
         }
+
+        offset = subFile.dataOffset + subFile.compressedSize;
+
+        d_ptr->listFile.push_back(subFile);
     }
 
+    d_ptr->filePakName = Impl::cacheFileName(pakFileName);
+    d_ptr->cacheArchive = PakCache::instance().registerArchive(d_ptr->filePakName, Impl::cacheStamp(pakFileName));
+
     return true;
 }
 
@@ -158,7 +474,7 @@ void Pak::close()
 
 bool Pak::isOpen() const
 {
-    return d_ptr->filePak.is_open();
+    return d_ptr->filePak.isOpen();
 }
 
 int Pak::fileCount() const
@@ -173,39 +489,187 @@ std::string Pak::fileName(int index) const
 
 std::vector<uint8_t> Pak::fileData(int index) const
 {
-    if (index < 0 || index >= d_ptr->listFile.size()) {
-        LOG_ERROR("Index out of range");
+    if (d_ptr->isCached()) {
+        std::shared_ptr<const std::vector<uint8_t>> data = fileDataShared(index);
+        if (!data) {
+            return std::vector<uint8_t>();
+        }
+
+        return *data;
+    }
+
+    if (!d_ptr->checkIndex(index)) {
         return std::vector<uint8_t>();
     }
 
-    if (!isOpen()) {
-        LOG_ERROR("File not open");
+    std::vector<uint8_t> uncompressedData;
+    if (!d_ptr->uncompressFile(index, uncompressedData)) {
         return std::vector<uint8_t>();
     }
 
-    PakFile& subFile = d_ptr->listFile[index];
+    return uncompressedData;
+}
+
+std::shared_ptr<const std::vector<uint8_t>> Pak::fileDataShared(int index) const
+{
+    if (!d_ptr->checkIndex(index)) {
+        return nullptr;
+    }
+
+    // Entries changed by addFile are private to this instance, the cache is shared by every Pak on the same file
+    bool cached = d_ptr->isCached() && !d_ptr->listFile[index].inMemory;
+    if (cached) {
+        std::shared_ptr<const std::vector<uint8_t>> data = PakCache::instance().find(d_ptr->cacheArchive, index);
+        if (data) {
+            return data;
+        }
+    }
 
     std::vector<uint8_t> uncompressedData;
-    uncompressedData.reserve(subFile.uncompressedSize);
-    switch (subFile.compressionLevel) {
-    case 3:
-        Impl::uncompressPakData3(subFile.compressedData, uncompressedData);
-        break;
+    if (!d_ptr->uncompressFile(index, uncompressedData)) {
+        return nullptr;
+    }
 
-    default:
-        LOG_ERROR("Compression not yet known");
-        break;
+    auto data = std::make_shared<const std::vector<uint8_t>>(std::move(uncompressedData));
+    if (cached) {
+        PakCache::instance().insert(d_ptr->cacheArchive, index, data);
     }
 
-    if (uncompressedData.size() != subFile.uncompressedSize) {
-        LOG_ERROR("Uncompressed size does not match");
-        LOG_ERROR("    Expected: {}", subFile.uncompressedSize);
-        LOG_ERROR("    Actual: {}", uncompressedData.size());
+    return data;
+}
 
-        return std::vector<uint8_t>();
+bool Pak::addFile(const std::string& fileName, const std::vector<uint8_t>& data, CompressionEffort effort)
+{
+    if (fileName.empty() || fileName.size() > 15) {
+        LOG_ERROR("Invalid file name: {}", fileName);
+        return false;
     }
 
-    return uncompressedData;
+    if (data.size() > UINT32_MAX) {
+        LOG_ERROR("File too large: {}", fileName);
+        return false;
+    }
+
+    PakFile subFile;
+    subFile.fileName = fileName;
+    subFile.compressionLevel = 3;
+    subFile.uncompressedSize = data.size();
+    subFile.inMemory = true;
+    Impl::compressPakData3(data, subFile.compressedData, effort);
+    subFile.compressedSize = subFile.compressedData.size();
+
+    auto it = std::find_if(d_ptr->listFile.begin(), d_ptr->listFile.end(), [&](const PakFile& file) {
+        return file.fileName == fileName;
+    });
+    if (it != d_ptr->listFile.end()) {
+        *it = std::move(subFile);
+    } else {
+        d_ptr->listFile.push_back(std::move(subFile));
+    }
+
+    return true;
+}
+
+bool Pak::save(const std::string& pakFileName)
+{
+    // Header + (name + level + compressed size + uncompressed size + data) per file
+    uint64_t fileSize = PAK_HEADER_SIZE;
+    for (const PakFile& subFile : d_ptr->listFile) {
+        fileSize += PAK_ENTRY_HEADER_SIZE + subFile.compressedSize;
+    }
+
+    if (fileSize > UINT32_MAX) {
+        LOG_ERROR("Archive too large: {} bytes", fileSize);
+        return false;
+    }
+
+    // Overwriting the opened archive: its data must be read before truncating it
+    std::string cacheName = Impl::cacheFileName(pakFileName);
+    bool overwriteSource = isOpen() && cacheName == d_ptr->filePakName;
+
+    std::vector<std::vector<uint8_t>> sourceData;
+    if (overwriteSource) {
+        sourceData.resize(d_ptr->listFile.size());
+        for (size_t i = 0; i < d_ptr->listFile.size(); ++i) {
+            const PakFile& subFile = d_ptr->listFile[i];
+            if (!subFile.inMemory && !d_ptr->readCompressed(subFile, sourceData[i])) {
+                return false;
+            }
+        }
+    }
+
+    std::fstream filePak(pakFileName, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if (!filePak.is_open()) {
+        LOG_ERROR("Could not open file: {}", pakFileName);
+        return false;
+    }
+
+    ofnx::tools::DataStream ds(&filePak);
+    ds.setEndian(std::endian::little);
+
+    ds.write(4, d_ptr->header);
+    ds << uint32_t(fileSize);
+
+    std::vector<uint64_t> dataOffsets;
+    uint64_t offset = PAK_HEADER_SIZE;
+    std::vector<uint8_t> compressedData;
+    for (size_t i = 0; i < d_ptr->listFile.size(); ++i) {
+        const PakFile& subFile = d_ptr->listFile[i];
+
+        const std::vector<uint8_t>* data = &subFile.compressedData;
+        if (overwriteSource && !subFile.inMemory) {
+            data = &sourceData[i];
+        } else if (!subFile.inMemory) {
+            if (!d_ptr->readCompressed(subFile, compressedData)) {
+                return false;
+            }
+            data = &compressedData;
+        }
+
+        uint8_t compFileName[16] = { 0 };
+        std::memcpy(compFileName, subFile.fileName.data(), std::min<size_t>(subFile.fileName.size(), 15));
+        ds.write(16, compFileName);
+
+        ds << subFile.compressionLevel;
+        ds << subFile.compressedSize;
+        ds << subFile.uncompressedSize;
+
+        ds.write(subFile.compressedSize, data->data());
+
+        offset += PAK_ENTRY_HEADER_SIZE;
+        dataOffsets.push_back(offset);
+        offset += subFile.compressedSize;
+    }
+
+    filePak.close();
+
+    // Cached entries of a previous archive with the same name are now stale
+    PakCache& cache = PakCache::instance();
+    cache.removeArchive(cache.registerArchive(cacheName, Impl::cacheStamp(pakFileName)));
+
+    if (filePak.fail()) {
+        LOG_ERROR("Error while writing file: {}", pakFileName);
+        return false;
+    }
+
+    // Entries now live at their new location in the rewritten archive
+    if (overwriteSource) {
+        if (!d_ptr->filePak.open(pakFileName)) {
+            return false;
+        }
+
+        for (size_t i = 0; i < d_ptr->listFile.size(); ++i) {
+            PakFile& subFile = d_ptr->listFile[i];
+            subFile.dataOffset = dataOffsets[i];
+            subFile.inMemory = false;
+            subFile.compressedData = std::vector<uint8_t>();
+        }
+
+        // Same archive id, its stale entries were purged above
+        d_ptr->cacheArchive = PakCache::instance().registerArchive(d_ptr->filePakName, Impl::cacheStamp(pakFileName));
+    }
+
+    return true;
 }
 
 } // namespace ofnx::files
@@ -0,0 +1,233 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "ofnx/files/pakcache.h"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace ofnx::files {
+
+/* PRIVATE */
+class PakCache::Impl {
+    friend class PakCache;
+
+public:
+    struct Entry {
+        uint64_t key;
+        std::shared_ptr<const std::vector<uint8_t>> data;
+    };
+
+    struct Archive {
+        uint32_t id;
+        uint64_t stamp;
+    };
+
+    static uint64_t makeKey(uint32_t archive, uint32_t index);
+
+    void evict(size_t budget);
+    void erase(std::list<Entry>::iterator it);
+
+private:
+    mutable std::mutex m_mutex;
+
+    // Most recently used entries first
+    std::list<Entry> m_lru;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> m_entries;
+
+    std::unordered_map<std::string, Archive> m_archives;
+    uint32_t m_nextArchive = 1;
+
+    size_t m_budget = 0;
+    Stats m_stats;
+};
+
+uint64_t PakCache::Impl::makeKey(uint32_t archive, uint32_t index)
+{
+    return (uint64_t(archive) << 32) | index;
+}
+
+void PakCache::Impl::evict(size_t budget)
+{
+    while (m_stats.bytes > budget && !m_lru.empty()) {
+        erase(std::prev(m_lru.end()));
+        ++m_stats.evictions;
+    }
+}
+
+void PakCache::Impl::erase(std::list<Entry>::iterator it)
+{
+    m_stats.bytes -= it->data->size();
+    --m_stats.entries;
+
+    m_entries.erase(it->key);
+    m_lru.erase(it);
+}
+
+PakCache::PakCache()
+{
+    d_ptr = new Impl;
+}
+
+PakCache::~PakCache()
+{
+    delete d_ptr;
+}
+
+uint32_t PakCache::registerArchive(const std::string& pakFileName, uint64_t stamp)
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    auto it = d_ptr->m_archives.find(pakFileName);
+    if (it == d_ptr->m_archives.end()) {
+        Impl::Archive archive { d_ptr->m_nextArchive++, stamp };
+        d_ptr->m_archives[pakFileName] = archive;
+        return archive.id;
+    }
+
+    if (it->second.stamp != stamp) {
+        // File changed on disk since it was cached, drop its old entries
+        it->second.stamp = stamp;
+        for (auto entry = d_ptr->m_lru.begin(); entry != d_ptr->m_lru.end();) {
+            auto current = entry++;
+            if ((current->key >> 32) == it->second.id) {
+                d_ptr->erase(current);
+            }
+        }
+    }
+
+    return it->second.id;
+}
+
+void PakCache::removeArchive(uint32_t archive)
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    for (auto entry = d_ptr->m_lru.begin(); entry != d_ptr->m_lru.end();) {
+        auto current = entry++;
+        if ((current->key >> 32) == archive) {
+            d_ptr->erase(current);
+        }
+    }
+}
+
+std::shared_ptr<const std::vector<uint8_t>> PakCache::find(uint32_t archive, uint32_t index)
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    auto it = d_ptr->m_entries.find(Impl::makeKey(archive, index));
+    if (it == d_ptr->m_entries.end()) {
+        ++d_ptr->m_stats.misses;
+        return nullptr;
+    }
+
+    ++d_ptr->m_stats.hits;
+    d_ptr->m_lru.splice(d_ptr->m_lru.begin(), d_ptr->m_lru, it->second);
+
+    return it->second->data;
+}
+
+void PakCache::insert(uint32_t archive, uint32_t index, const std::shared_ptr<const std::vector<uint8_t>>& data)
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    if (!data || data->size() > d_ptr->m_budget) {
+        return;
+    }
+
+    uint64_t key = Impl::makeKey(archive, index);
+    auto it = d_ptr->m_entries.find(key);
+    if (it != d_ptr->m_entries.end()) {
+        d_ptr->erase(it->second);
+    }
+
+    d_ptr->evict(d_ptr->m_budget - data->size());
+
+    d_ptr->m_lru.push_front({ key, data });
+    d_ptr->m_entries[key] = d_ptr->m_lru.begin();
+
+    d_ptr->m_stats.bytes += data->size();
+    ++d_ptr->m_stats.entries;
+}
+
+void PakCache::remove(uint32_t archive, uint32_t index)
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    auto it = d_ptr->m_entries.find(Impl::makeKey(archive, index));
+    if (it != d_ptr->m_entries.end()) {
+        d_ptr->erase(it->second);
+    }
+}
+
+/* PUBLIC */
+PakCache& PakCache::instance()
+{
+    static PakCache cache;
+    return cache;
+}
+
+void PakCache::setBudget(size_t bytes)
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    d_ptr->m_budget = bytes;
+    d_ptr->evict(bytes);
+}
+
+size_t PakCache::budget() const
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    return d_ptr->m_budget;
+}
+
+PakCache::Stats PakCache::stats() const
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    return d_ptr->m_stats;
+}
+
+void PakCache::resetStats()
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    d_ptr->m_stats.hits = 0;
+    d_ptr->m_stats.misses = 0;
+    d_ptr->m_stats.evictions = 0;
+}
+
+void PakCache::clear()
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    d_ptr->m_lru.clear();
+    d_ptr->m_entries.clear();
+    d_ptr->m_stats.bytes = 0;
+    d_ptr->m_stats.entries = 0;
+}
+
+} // namespace ofnx::files
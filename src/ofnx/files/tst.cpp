@@ -24,11 +24,18 @@ SOFTWARE.
 
 #include "ofnx/files/tst.h"
 
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cmath>
 #include <fstream>
+#include <functional>
+#include <limits>
 #include <vector>
 
 #include "ofnx/tools/datastream.h"
 #include "ofnx/tools/log.h"
+#include "ofnx/tools/simd.h"
 
 namespace ofnx::files {
 
@@ -45,10 +52,281 @@ public:
         float y2;
     };
 
+    /*
+     * Normalised zone bounds, one array per bound
+     * Arrays are padded to a multiple of 8 with empty zones (min = +inf, max = -inf)
+     */
+    struct ZoneTable {
+        std::vector<float> minX;
+        std::vector<float> maxX;
+        std::vector<float> minY;
+        std::vector<float> maxY;
+
+        void clear();
+        void add(float zoneMinX, float zoneMaxX, float zoneMinY, float zoneMaxY);
+        void pad();
+    };
+
+    enum class Cover {
+        NONE,
+        PARTIAL,
+        FULL,
+    };
+
+    struct ZoneGrid {
+        int width = 0;
+        int height = 0;
+        float step = 0.0f;
+        std::vector<int16_t> cells;
+    };
+
+public:
+    void buildTables();
+    void buildZoneMaps();
+
+    static int scanZones(const ZoneTable& table, float x1, float x2, float y1, float y2);
+    static Cover coverStatic(float zoneMin, float zoneMax, int cell);
+    static Cover coverVr(float zoneMin, float zoneMax, float cellMinDeg, float cellMaxDeg);
+    static void rasterise(ZoneGrid& grid, size_t zoneCount,
+        const std::function<Cover(size_t zone, int column)>& coverColumn,
+        const std::function<Cover(size_t zone, int row)>& coverRow);
+
 private:
     std::vector<Zone> m_listZone;
+    ZoneTable m_tableStatic;
+    ZoneTable m_tableVr;
+
+    bool m_zoneMapsEnabled = false;
+    float m_zoneMapVrStep = 0.5f;
+    ZoneGrid m_gridStatic;
+    ZoneGrid m_gridVr;
 };
 
+void Tst::Impl::ZoneTable::clear()
+{
+    minX.clear();
+    maxX.clear();
+    minY.clear();
+    maxY.clear();
+}
+
+void Tst::Impl::ZoneTable::add(float zoneMinX, float zoneMaxX, float zoneMinY, float zoneMaxY)
+{
+    minX.push_back(zoneMinX);
+    maxX.push_back(zoneMaxX);
+    minY.push_back(zoneMinY);
+    maxY.push_back(zoneMaxY);
+}
+
+void Tst::Impl::ZoneTable::pad()
+{
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    while (minX.size() % 8 != 0) {
+        add(inf, -inf, inf, -inf);
+    }
+}
+
+void Tst::Impl::buildTables()
+{
+    m_tableStatic.clear();
+    m_tableVr.clear();
+
+    for (const auto& zone : m_listZone) {
+        float minX = std::min(zone.x1, zone.x2);
+        float maxX = std::max(zone.x1, zone.x2);
+
+        float minY = std::min(zone.y1, zone.y2);
+        float maxY = std::max(zone.y1, zone.y2);
+
+        m_tableStatic.add(minX, maxX, minY, maxY);
+
+        // Zones wider than half a turn wrap around 0
+        if (3.141593f < maxX - minX) {
+            float tmpX = maxX;
+            maxX = minX + 6.283185f;
+            minX = tmpX;
+        }
+
+        if (3.141593f < maxY - minY) {
+            float tmpY = maxY;
+            maxY = minY + 6.283185f;
+            minY = tmpY;
+        }
+
+        m_tableVr.add(minX, maxX, minY, maxY);
+    }
+
+    m_tableStatic.pad();
+    m_tableVr.pad();
+}
+
+void Tst::Impl::buildZoneMaps()
+{
+    m_gridStatic = {};
+    m_gridVr = {};
+
+    if (!m_zoneMapsEnabled) {
+        return;
+    }
+
+    if (m_listZone.size() > INT16_MAX) {
+        LOG_ERROR("Too many zones for zone maps: {}", m_listZone.size());
+        return;
+    }
+
+    m_gridStatic.width = 640;
+    m_gridStatic.height = 480;
+    m_gridStatic.step = 1.0f;
+    rasterise(
+        m_gridStatic, m_listZone.size(),
+        [&](size_t zone, int column) { return coverStatic(m_tableStatic.minX[zone], m_tableStatic.maxX[zone], column); },
+        [&](size_t zone, int row) { return coverStatic(m_tableStatic.minY[zone], m_tableStatic.maxY[zone], row); });
+
+    float step = m_zoneMapVrStep;
+    m_gridVr.width = std::ceil(360.0f / step);
+    m_gridVr.height = std::floor(180.0f / step) + 1;
+    m_gridVr.step = step;
+    rasterise(
+        m_gridVr, m_listZone.size(),
+        [&](size_t zone, int column) {
+            return coverVr(m_tableVr.minX[zone], m_tableVr.maxX[zone], column * step, (column + 1) * step);
+        },
+        [&](size_t zone, int row) {
+            return coverVr(m_tableVr.minY[zone], m_tableVr.maxY[zone], row * step - 90.0f, (row + 1) * step - 90.0f);
+        });
+}
+
+/*
+ * Classifies how a zone range covers the coordinates falling into a static map cell [cell, cell + 1[
+ */
+Tst::Impl::Cover Tst::Impl::coverStatic(float zoneMin, float zoneMax, int cell)
+{
+    if (zoneMin <= cell && cell + 1 <= zoneMax) {
+        return Cover::FULL;
+    }
+
+    if (zoneMax < cell || cell + 1 < zoneMin) {
+        return Cover::NONE;
+    }
+
+    return Cover::PARTIAL;
+}
+
+/*
+ * Same as coverStatic for a VR grid cell, following checkZoneVr arithmetic
+ * Angles are widened by a small margin to absorb the rounding of the cell index computation,
+ * the radian conversion and the 2 * pi shift are monotonic so range bounds stay conservative
+ */
+Tst::Impl::Cover Tst::Impl::coverVr(float zoneMin, float zoneMax, float cellMinDeg, float cellMaxDeg)
+{
+    float min1 = (cellMinDeg - 0.001f) * 0.0174532925f;
+    float max1 = (cellMaxDeg + 0.001f) * 0.0174532925f;
+    float min2 = min1 + 6.283185f;
+    float max2 = max1 + 6.283185f;
+
+    if ((zoneMin <= min1 && max1 <= zoneMax) || (zoneMin <= min2 && max2 <= zoneMax)) {
+        return Cover::FULL;
+    }
+
+    if ((zoneMax < min1 || max1 < zoneMin) && (zoneMax < min2 || max2 < zoneMin)) {
+        return Cover::NONE;
+    }
+
+    return Cover::PARTIAL;
+}
+
+/*
+ * Writes the first zone fully covering each cell, in scan order
+ * A cell touched by a zone before being fully covered is marked as border
+ */
+void Tst::Impl::rasterise(ZoneGrid& grid, size_t zoneCount,
+    const std::function<Cover(size_t zone, int column)>& coverColumn,
+    const std::function<Cover(size_t zone, int row)>& coverRow)
+{
+    grid.cells.assign(grid.width * grid.height, ZONE_MAP_NONE);
+
+    std::vector<Cover> columns(grid.width);
+    for (size_t zone = 0; zone < zoneCount; ++zone) {
+        bool anyColumn = false;
+        for (int x = 0; x < grid.width; ++x) {
+            columns[x] = coverColumn(zone, x);
+            anyColumn |= columns[x] != Cover::NONE;
+        }
+
+        if (!anyColumn) {
+            continue;
+        }
+
+        for (int y = 0; y < grid.height; ++y) {
+            Cover row = coverRow(zone, y);
+            if (row == Cover::NONE) {
+                continue;
+            }
+
+            int16_t* cells = grid.cells.data() + y * grid.width;
+            for (int x = 0; x < grid.width; ++x) {
+                if (columns[x] == Cover::NONE || cells[x] != ZONE_MAP_NONE) {
+                    continue;
+                }
+
+                bool full = (row == Cover::FULL) && (columns[x] == Cover::FULL);
+                cells[x] = full ? int16_t(zone) : ZONE_MAP_BORDER;
+            }
+        }
+    }
+}
+
+/*
+ * Returns the first zone containing (x1 or x2, y1 or y2), -1 if none
+ * The second coordinates carry the shifted angles used for wrap-around zones
+ */
+int Tst::Impl::scanZones(const ZoneTable& table, float x1, float x2, float y1, float y2)
+{
+    size_t count = table.minX.size();
+    size_t i = 0;
+
+#ifdef OFNX_SIMD_SSE2
+    const __m128 vx1 = _mm_set1_ps(x1);
+    const __m128 vx2 = _mm_set1_ps(x2);
+    const __m128 vy1 = _mm_set1_ps(y1);
+    const __m128 vy2 = _mm_set1_ps(y2);
+
+    auto test4 = [&](size_t j) {
+        __m128 minX = _mm_loadu_ps(table.minX.data() + j);
+        __m128 maxX = _mm_loadu_ps(table.maxX.data() + j);
+        __m128 minY = _mm_loadu_ps(table.minY.data() + j);
+        __m128 maxY = _mm_loadu_ps(table.maxY.data() + j);
+
+        __m128 inX1 = _mm_and_ps(_mm_cmple_ps(minX, vx1), _mm_cmple_ps(vx1, maxX));
+        __m128 inX2 = _mm_and_ps(_mm_cmple_ps(minX, vx2), _mm_cmple_ps(vx2, maxX));
+        __m128 inY1 = _mm_and_ps(_mm_cmple_ps(minY, vy1), _mm_cmple_ps(vy1, maxY));
+        __m128 inY2 = _mm_and_ps(_mm_cmple_ps(minY, vy2), _mm_cmple_ps(vy2, maxY));
+
+        return _mm_movemask_ps(_mm_and_ps(_mm_or_ps(inX1, inX2), _mm_or_ps(inY1, inY2)));
+    };
+
+    for (; i < count; i += 8) {
+        int mask = test4(i) | (test4(i + 4) << 4);
+        if (mask != 0) {
+            return i + std::countr_zero(unsigned(mask));
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        bool inX1 = (table.minX[i] <= x1) && (x1 <= table.maxX[i]);
+        bool inX2 = (table.minX[i] <= x2) && (x2 <= table.maxX[i]);
+        bool inY1 = (table.minY[i] <= y1) && (y1 <= table.maxY[i]);
+        bool inY2 = (table.minY[i] <= y2) && (y2 <= table.maxY[i]);
+
+        if ((inX1 || inX2) && (inY1 || inY2)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
 /* PUBLIC */
 Tst::Tst()
 {
@@ -63,6 +341,8 @@ Tst::~Tst()
 bool Tst::loadFile(const std::string& fileName)
 {
     d_ptr->m_listZone.clear();
+    d_ptr->buildTables();
+    d_ptr->buildZoneMaps();
 
     std::fstream tstFile(fileName, std::ios::binary | std::ios::in);
     if (!tstFile.is_open()) {
@@ -89,59 +369,96 @@ bool Tst::loadFile(const std::string& fileName)
         d_ptr->m_listZone.push_back(zone);
     }
 
+    d_ptr->buildTables();
+    d_ptr->buildZoneMaps();
+
     return true;
 }
 
-int Tst::checkZoneStatic(float x, float y)
+int Tst::zoneCount() const
 {
-    for (const auto& zone : d_ptr->m_listZone) {
-        float minX = std::min(zone.x1, zone.x2);
-        float maxX = std::max(zone.x1, zone.x2);
-
-        float minY = std::min(zone.y1, zone.y2);
-        float maxY = std::max(zone.y1, zone.y2);
+    return d_ptr->m_listZone.size();
+}
 
-        if ((minX <= x) && (x <= maxX) && (minY <= y) && (y <= maxY)) {
-            return zone.index;
+int Tst::checkZoneStatic(float x, float y) const
+{
+    const Impl::ZoneGrid& grid = d_ptr->m_gridStatic;
+    if (!grid.cells.empty() && 0.0f <= x && x < grid.width && 0.0f <= y && y < grid.height) {
+        int16_t zone = grid.cells[int(y) * grid.width + int(x)];
+        if (zone != ZONE_MAP_BORDER) {
+            return zone;
         }
     }
 
-    return -1;
+    return Impl::scanZones(d_ptr->m_tableStatic, x, x, y, y);
 }
 
-int Tst::checkZoneVr(float yawDeg, float pitchDeg)
+int Tst::checkZoneVr(float yawDeg, float pitchDeg) const
 {
     float yaw = yawDeg * 0.0174532925f; // Convert to radians
     float pitch = pitchDeg * 0.0174532925f; // Convert to radians
 
-    for (const auto& zone : d_ptr->m_listZone) {
-        float minX = std::min(zone.x1, zone.x2);
-        float maxX = std::max(zone.x1, zone.x2);
-        if (3.141593f < maxX - minX) {
-            float tmpX = maxX;
-            maxX = minX + 6.283185f;
-            minX = tmpX;
+    const Impl::ZoneGrid& grid = d_ptr->m_gridVr;
+    if (!grid.cells.empty() && 0.0f <= yawDeg && yawDeg < 360.0f && -90.0f <= pitchDeg && pitchDeg <= 90.0f) {
+        int column = yawDeg / grid.step;
+        int row = (pitchDeg + 90.0f) / grid.step;
+        if (column < grid.width && row < grid.height) {
+            int16_t zone = grid.cells[row * grid.width + column];
+            if (zone != ZONE_MAP_BORDER) {
+                return zone;
+            }
         }
+    }
 
-        float minY = std::min(zone.y1, zone.y2);
-        float maxY = std::max(zone.y1, zone.y2);
-        if (3.141593f < maxY - minY) {
-            float tmpY = maxY;
-            maxY = minY + 6.283185f;
-            minY = tmpY;
-        }
+    return Impl::scanZones(d_ptr->m_tableVr, yaw, yaw + 6.283185f, pitch, pitch + 6.283185f);
+}
 
-        bool inX1 = (minX <= yaw) && (yaw <= maxX);
-        bool inX2 = (minX <= yaw + 6.283185f) && (yaw + 6.283185f <= maxX);
-        bool inY1 = (minY <= pitch) && (pitch <= maxY);
-        bool inY2 = (minY <= pitch + 6.283185f) && (pitch + 6.283185f <= maxY);
+void Tst::checkZoneStatic(std::span<const float> points, std::span<int> zones) const
+{
+    size_t count = std::min(points.size() / 2, zones.size());
+    for (size_t i = 0; i < count; ++i) {
+        zones[i] = checkZoneStatic(points[i * 2], points[i * 2 + 1]);
+    }
+}
 
-        if ((inX1 || inX2) && (inY1 || inY2)) {
-            return zone.index;
-        }
+void Tst::checkZoneVr(std::span<const float> anglesDeg, std::span<int> zones) const
+{
+    size_t count = std::min(anglesDeg.size() / 2, zones.size());
+    for (size_t i = 0; i < count; ++i) {
+        zones[i] = checkZoneVr(anglesDeg[i * 2], anglesDeg[i * 2 + 1]);
     }
+}
 
-    return -1;
+bool Tst::enableZoneMaps(float vrStepDeg)
+{
+    if (!(vrStepDeg >= 0.05f && vrStepDeg <= 90.0f)) {
+        LOG_ERROR("Invalid zone map resolution: {}", vrStepDeg);
+        return false;
+    }
+
+    d_ptr->m_zoneMapsEnabled = true;
+    d_ptr->m_zoneMapVrStep = vrStepDeg;
+    d_ptr->buildZoneMaps();
+
+    return true;
+}
+
+void Tst::disableZoneMaps()
+{
+    d_ptr->m_zoneMapsEnabled = false;
+    d_ptr->buildZoneMaps();
+}
+
+Tst::ZoneMap Tst::zoneMapStatic() const
+{
+    const Impl::ZoneGrid& grid = d_ptr->m_gridStatic;
+    return { grid.width, grid.height, grid.step, grid.cells };
+}
+
+Tst::ZoneMap Tst::zoneMapVr() const
+{
+    const Impl::ZoneGrid& grid = d_ptr->m_gridVr;
+    return { grid.width, grid.height, grid.step, grid.cells };
 }
 
 } // namespace ofnx::files
@@ -250,6 +250,19 @@ Vr::Type Vr::getType() const
     return d_ptr->m_vrType;
 }
 
+size_t Vr::getDataSize() const
+{
+    size_t size = d_ptr->m_dctData.capacity();
+    for (const auto& [name, anim] : d_ptr->m_animationList) {
+        size += name.capacity() + anim.frameList.capacity() * sizeof(Impl::AnimFrame);
+        for (const Impl::AnimFrame& frame : anim.frameList) {
+            size += frame.blockOffsetList.capacity() * sizeof(uint32_t) + frame.dctData.capacity();
+        }
+    }
+
+    return size;
+}
+
 bool Vr::getDataRgb565(std::vector<uint16_t>& dataRgb565) const
 {
     ofnx::graphics::Dct dct;
@@ -0,0 +1,421 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "ofnx/files/warppreloader.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "ofnx/files/lstgraph.h"
+#include "ofnx/files/tst.h"
+#include "ofnx/files/vr.h"
+#include "ofnx/tools/log.h"
+
+namespace ofnx::files {
+
+#define WARP_PRELOADER_DEFAULT_THREADS 2
+#define WARP_PRELOADER_DEFAULT_BUDGET (64 * 1024 * 1024)
+
+/* PRIVATE */
+class WarpPreloader::Impl {
+    friend class WarpPreloader;
+
+public:
+    struct Job {
+        std::string name;
+        int priority; // Lower first
+        uint64_t generation;
+    };
+
+    struct Entry {
+        std::string name;
+        std::shared_ptr<const Warp> warp;
+        size_t bytes;
+    };
+
+    std::shared_ptr<const Warp> loadWarp(const std::string& name, const std::filesystem::path& directory) const;
+    void workerLoop();
+
+    void schedule();
+    std::shared_ptr<const Warp> findCached(const std::string& name);
+    void insert(const std::string& name, const std::shared_ptr<const Warp>& warp, bool recent);
+    void evict(size_t budget);
+    void erase(std::list<Entry>::iterator it);
+
+private:
+    std::vector<std::thread> m_threads;
+    bool m_stop = false;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobCondition;
+    std::condition_variable m_doneCondition;
+
+    std::vector<Job> m_jobs;
+    std::unordered_set<std::string> m_loading;
+    uint64_t m_generation = 0;
+
+    // Most recently used warps first
+    std::list<Entry> m_lru;
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_entries;
+    size_t m_budget = WARP_PRELOADER_DEFAULT_BUDGET;
+    Stats m_stats;
+
+    std::string m_dataDirectory;
+    uint64_t m_directoryGeneration = 0; // Loads started before a directory change are dropped
+    const LstGraph* m_graph = nullptr;
+    int m_maxClicks = 1;
+    int m_currentWarp = -1;
+    int m_hoveredTest = -1;
+};
+
+/**
+ * Called without the lock held, directory is read by the caller along with m_directoryGeneration.
+ */
+std::shared_ptr<const WarpPreloader::Warp> WarpPreloader::Impl::loadWarp(const std::string& name, const std::filesystem::path& directory) const
+{
+    auto warp = std::make_shared<Warp>();
+    warp->name = name;
+
+    warp->vr = std::make_shared<Vr>();
+    if (!warp->vr->load((directory / name).string())) {
+        LOG_WARN("Failed to preload warp {}", name);
+        return nullptr;
+    }
+
+    if (!warp->vr->getDataRgb565(warp->dataRgb565)) {
+        LOG_WARN("Failed to decode warp {}", name);
+        return nullptr;
+    }
+
+    // Test file shares the warp base name, see Lst::saveLst
+    if (name.size() > 3) {
+        std::filesystem::path tstFileName = directory / (name.substr(0, name.size() - 3) + ".tst");
+        if (std::filesystem::exists(tstFileName)) {
+            warp->tst = std::make_shared<Tst>();
+            if (!warp->tst->loadFile(tstFileName.string())) {
+                warp->tst.reset();
+            }
+        }
+    }
+
+    return warp;
+}
+
+void WarpPreloader::Impl::workerLoop()
+{
+    std::unique_lock lock(m_mutex);
+
+    while (true) {
+        m_jobCondition.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+        if (m_stop) {
+            break;
+        }
+
+        auto best = std::min_element(m_jobs.begin(), m_jobs.end(), [](const Job& a, const Job& b) { return a.priority < b.priority; });
+        Job job = std::move(*best);
+        m_jobs.erase(best);
+
+        if (m_entries.contains(job.name) || !m_loading.insert(job.name).second) {
+            continue;
+        }
+
+        std::filesystem::path directory = m_dataDirectory;
+        uint64_t directoryGeneration = m_directoryGeneration;
+
+        lock.unlock();
+        std::shared_ptr<const Warp> warp = loadWarp(job.name, directory);
+        lock.lock();
+
+        m_loading.erase(job.name);
+        if (warp && directoryGeneration == m_directoryGeneration) {
+            // Result of a cancelled job is the first to go
+            insert(job.name, warp, job.generation == m_generation);
+            ++m_stats.loads;
+        }
+        m_doneCondition.notify_all();
+    }
+}
+
+void WarpPreloader::Impl::schedule()
+{
+    m_jobs.clear();
+    if (m_graph == nullptr || m_currentWarp < 0) {
+        return;
+    }
+
+    std::unordered_map<int, int> priorities;
+    for (const LstGraph::Reach& reach : m_graph->reachable(m_currentWarp, m_maxClicks)) {
+        priorities[reach.warpId] = 1 + 2 * reach.clicks;
+    }
+
+    if (m_hoveredTest >= 0) {
+        for (const LstGraph::Edge& edge : m_graph->edges(m_currentWarp)) {
+            if (edge.testId == m_hoveredTest && edge.to != m_currentWarp) {
+                priorities[edge.to] = 0;
+            }
+        }
+    }
+
+    for (const auto& [warpId, priority] : priorities) {
+        const std::string& name = m_graph->warpName(warpId);
+        if (!m_entries.contains(name) && !m_loading.contains(name)) {
+            m_jobs.push_back({ name, priority, m_generation });
+        }
+    }
+
+    if (!m_jobs.empty()) {
+        m_jobCondition.notify_all();
+    }
+}
+
+std::shared_ptr<const WarpPreloader::Warp> WarpPreloader::Impl::findCached(const std::string& name)
+{
+    auto it = m_entries.find(name);
+    if (it == m_entries.end()) {
+        return nullptr;
+    }
+
+    ++m_stats.hits;
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+
+    return it->second->warp;
+}
+
+void WarpPreloader::Impl::insert(const std::string& name, const std::shared_ptr<const Warp>& warp, bool recent)
+{
+    // Decoded pixels plus what the Vr keeps for animations
+    size_t bytes = sizeof(Warp) + warp->dataRgb565.size() * sizeof(uint16_t) + warp->vr->getDataSize();
+    if (bytes > m_budget) {
+        return;
+    }
+
+    auto it = m_entries.find(name);
+    if (it != m_entries.end()) {
+        erase(it->second);
+    }
+
+    evict(m_budget - bytes);
+
+    auto position = recent ? m_lru.begin() : m_lru.end();
+    m_entries[name] = m_lru.insert(position, { name, warp, bytes });
+
+    m_stats.bytes += bytes;
+    ++m_stats.entries;
+}
+
+void WarpPreloader::Impl::evict(size_t budget)
+{
+    while (m_stats.bytes > budget && !m_lru.empty()) {
+        erase(std::prev(m_lru.end()));
+        ++m_stats.evictions;
+    }
+}
+
+void WarpPreloader::Impl::erase(std::list<Entry>::iterator it)
+{
+    m_stats.bytes -= it->bytes;
+    --m_stats.entries;
+
+    m_entries.erase(it->name);
+    m_lru.erase(it);
+}
+
+/* PUBLIC */
+WarpPreloader::WarpPreloader(int threadCount)
+{
+    d_ptr = new Impl;
+
+    if (threadCount <= 0) {
+        threadCount = WARP_PRELOADER_DEFAULT_THREADS;
+    }
+
+    for (int i = 0; i < threadCount; ++i) {
+        d_ptr->m_threads.emplace_back(&Impl::workerLoop, d_ptr);
+    }
+}
+
+WarpPreloader::~WarpPreloader()
+{
+    {
+        std::lock_guard lock(d_ptr->m_mutex);
+        d_ptr->m_stop = true;
+        d_ptr->m_jobs.clear();
+    }
+    d_ptr->m_jobCondition.notify_all();
+
+    for (std::thread& thread : d_ptr->m_threads) {
+        thread.join();
+    }
+
+    delete d_ptr;
+}
+
+void WarpPreloader::setDataDirectory(const std::string& directory)
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    if (d_ptr->m_dataDirectory != directory) {
+        d_ptr->m_dataDirectory = directory;
+        ++d_ptr->m_directoryGeneration;
+        ++d_ptr->m_generation;
+        d_ptr->m_lru.clear();
+        d_ptr->m_entries.clear();
+        d_ptr->m_stats.bytes = 0;
+        d_ptr->m_stats.entries = 0;
+        d_ptr->schedule();
+    }
+}
+
+void WarpPreloader::setGraph(const LstGraph* graph)
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    d_ptr->m_graph = graph;
+    d_ptr->m_currentWarp = -1;
+    d_ptr->m_hoveredTest = -1;
+    ++d_ptr->m_generation;
+    d_ptr->schedule();
+}
+
+void WarpPreloader::setBudget(size_t bytes)
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    d_ptr->m_budget = bytes;
+    d_ptr->evict(bytes);
+}
+
+void WarpPreloader::setMaxClicks(int maxClicks)
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    d_ptr->m_maxClicks = std::max(0, maxClicks);
+    d_ptr->schedule();
+}
+
+void WarpPreloader::setCurrentWarp(int warpId)
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    if (d_ptr->m_currentWarp == warpId) {
+        return;
+    }
+
+    d_ptr->m_currentWarp = warpId;
+    d_ptr->m_hoveredTest = -1;
+    ++d_ptr->m_generation;
+    d_ptr->schedule();
+}
+
+void WarpPreloader::setHoveredTest(int testId)
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    if (d_ptr->m_hoveredTest == testId) {
+        return;
+    }
+
+    d_ptr->m_hoveredTest = testId;
+    d_ptr->schedule();
+}
+
+std::shared_ptr<const WarpPreloader::Warp> WarpPreloader::get(const std::string& warpName)
+{
+    std::unique_lock lock(d_ptr->m_mutex);
+
+    while (true) {
+        // Wait for a running load rather than decoding the same warp twice
+        d_ptr->m_doneCondition.wait(lock, [&] { return !d_ptr->m_loading.contains(warpName); });
+
+        std::shared_ptr<const Warp> warp = d_ptr->findCached(warpName);
+        if (warp) {
+            return warp;
+        }
+
+        ++d_ptr->m_stats.misses;
+        std::erase_if(d_ptr->m_jobs, [&](const Impl::Job& job) { return job.name == warpName; });
+        d_ptr->m_loading.insert(warpName);
+
+        std::filesystem::path directory = d_ptr->m_dataDirectory;
+        uint64_t directoryGeneration = d_ptr->m_directoryGeneration;
+
+        lock.unlock();
+        warp = d_ptr->loadWarp(warpName, directory);
+        lock.lock();
+
+        d_ptr->m_loading.erase(warpName);
+        d_ptr->m_doneCondition.notify_all();
+
+        // Directory changed during the load, start over from the new one
+        if (directoryGeneration != d_ptr->m_directoryGeneration) {
+            continue;
+        }
+
+        if (warp) {
+            d_ptr->insert(warpName, warp, true);
+        }
+
+        return warp;
+    }
+}
+
+std::shared_ptr<const WarpPreloader::Warp> WarpPreloader::find(const std::string& warpName)
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    return d_ptr->findCached(warpName);
+}
+
+void WarpPreloader::cancel()
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    d_ptr->m_jobs.clear();
+    ++d_ptr->m_generation;
+}
+
+void WarpPreloader::clear()
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    d_ptr->m_lru.clear();
+    d_ptr->m_entries.clear();
+    d_ptr->m_stats.bytes = 0;
+    d_ptr->m_stats.entries = 0;
+}
+
+WarpPreloader::Stats WarpPreloader::stats() const
+{
+    std::lock_guard lock(d_ptr->m_mutex);
+
+    return d_ptr->m_stats;
+}
+
+} // namespace ofnx::files
@@ -0,0 +1,1175 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "ofnx/graphics/fxmdecoder.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#include "ofnx/tools/log.h"
+#include "ofnx/tools/simd.h"
+
+namespace ofnx::graphics {
+
+#define FXM_VLC_BITS 10 // Prefix code lookup bits, longer codes go through a sub table
+#define FXM_VLC_MAX_LENGTH 24
+#define FXM_VLC_SYMBOL_COUNT 257
+#define FXM_VLC_END_OF_STREAM 256
+#define FXM_MAX_STREAM_SIZE (1 << 26)
+#define FXM_BLOCK_TYPE_BITS 5
+
+/* Helper functions */
+// JPEG luma quantizer multiplied by the AAN IDCT scale factors
+constexpr int16_t DEQUANT[64] = {
+    16, 15, 13, 19, 24, 31, 28, 17,
+    17, 23, 25, 31, 36, 63, 45, 21,
+    18, 24, 27, 37, 52, 59, 49, 20,
+    16, 28, 34, 40, 60, 80, 51, 20,
+    18, 31, 48, 66, 68, 86, 56, 21,
+    19, 38, 56, 59, 64, 64, 48, 20,
+    27, 48, 55, 55, 56, 51, 35, 15,
+    20, 35, 34, 32, 31, 22, 15, 8
+};
+
+constexpr uint8_t ZIGZAG[64] = {
+    0, 1, 8, 16, 9, 2, 3, 10,
+    17, 24, 32, 25, 18, 11, 4, 5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13, 6, 7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63
+};
+
+// AAN IDCT constants (16.16 fixed point)
+constexpr int FIX_1_082392200 = 70936;
+constexpr int FIX_1_414213562 = 92682;
+constexpr int FIX_1_847759065 = 121095;
+constexpr int FIX_2_613125930 = 171254;
+
+// {code, length} of block types 0-6, for version 2 then version 1 streams, per block shape
+constexpr uint8_t BLOCK_TYPE_CODES[2][4][7][2] = {
+    {
+        { { 0, 1 }, { 2, 2 }, { 6, 3 }, { 14, 4 }, { 30, 5 }, { 31, 5 }, { 0, 0 } }, // {8, 4, 2} x {8, 4, 2}
+        { { 0, 1 }, { 0, 0 }, { 2, 2 }, { 6, 3 }, { 14, 4 }, { 15, 4 }, { 0, 0 } }, // {8, 4} x 1
+        { { 0, 1 }, { 2, 2 }, { 0, 0 }, { 6, 3 }, { 14, 4 }, { 15, 4 }, { 0, 0 } }, // 1 x {8, 4}
+        { { 0, 1 }, { 0, 0 }, { 0, 0 }, { 2, 2 }, { 6, 3 }, { 14, 4 }, { 15, 4 } } // 1 x 2, 2 x 1
+    },
+    {
+        { { 1, 2 }, { 4, 3 }, { 5, 3 }, { 0, 2 }, { 6, 3 }, { 7, 3 }, { 0, 0 } },
+        { { 1, 2 }, { 0, 0 }, { 2, 2 }, { 0, 2 }, { 6, 3 }, { 7, 3 }, { 0, 0 } },
+        { { 1, 2 }, { 2, 2 }, { 0, 0 }, { 0, 2 }, { 6, 3 }, { 7, 3 }, { 0, 0 } },
+        { { 1, 2 }, { 0, 0 }, { 0, 0 }, { 0, 2 }, { 2, 2 }, { 6, 3 }, { 7, 3 } }
+    }
+};
+
+// Block shape from [log2 height][log2 width], 1x1 blocks do not exist
+constexpr int8_t BLOCK_SHAPES[4][4] = {
+    { -1, 3, 1, 1 },
+    { 3, 0, 0, 0 },
+    { 2, 0, 0, 0 },
+    { 2, 0, 0, 0 }
+};
+
+struct BlockTypeEntry {
+    int8_t type;
+    int8_t length; // 0 if invalid
+};
+
+constexpr auto BLOCK_TYPE_LOOKUP = [] {
+    std::array<std::array<std::array<BlockTypeEntry, 1 << FXM_BLOCK_TYPE_BITS>, 4>, 2> lookup {};
+    for (int generation = 0; generation < 2; ++generation) {
+        for (int shape = 0; shape < 4; ++shape) {
+            for (int type = 0; type < 7; ++type) {
+                int code = BLOCK_TYPE_CODES[generation][shape][type][0];
+                int length = BLOCK_TYPE_CODES[generation][shape][type][1];
+                if (length == 0) {
+                    continue;
+                }
+
+                int first = code << (FXM_BLOCK_TYPE_BITS - length);
+                for (int i = first; i < first + (1 << (FXM_BLOCK_TYPE_BITS - length)); ++i) {
+                    lookup[generation][shape][i] = { int8_t(type), int8_t(length) };
+                }
+            }
+        }
+    }
+    return lookup;
+}();
+
+// Version 2 motion vectors {x, y}, version 1 streams use a 16x16 window instead
+constexpr int8_t MOTION_VECTORS[256][2] = {
+    { 0, 0 }, { 0, -1 }, { -1, 0 }, { 1, 0 }, { 0, 1 }, { -1, -1 }, { 1, -1 }, { -1, 1 },
+    { 1, 1 }, { 0, -2 }, { -2, 0 }, { 2, 0 }, { 0, 2 }, { -1, -2 }, { 1, -2 }, { -2, -1 },
+    { 2, -1 }, { -2, 1 }, { 2, 1 }, { -1, 2 }, { 1, 2 }, { -2, -2 }, { 2, -2 }, { -2, 2 },
+    { 2, 2 }, { 0, -3 }, { -3, 0 }, { 3, 0 }, { 0, 3 }, { -1, -3 }, { 1, -3 }, { -3, -1 },
+    { 3, -1 }, { -3, 1 }, { 3, 1 }, { -1, 3 }, { 1, 3 }, { -2, -3 }, { 2, -3 }, { -3, -2 },
+    { 3, -2 }, { -3, 2 }, { 3, 2 }, { -2, 3 }, { 2, 3 }, { 0, -4 }, { -4, 0 }, { 4, 0 },
+    { 0, 4 }, { -1, -4 }, { 1, -4 }, { -4, -1 }, { 4, -1 }, { 4, 1 }, { -1, 4 }, { 1, 4 },
+    { -3, -3 }, { -3, 3 }, { 3, 3 }, { -2, -4 }, { -4, -2 }, { 4, -2 }, { -4, 2 }, { -2, 4 },
+    { 2, 4 }, { -3, -4 }, { 3, -4 }, { 4, -3 }, { -5, 0 }, { -4, 3 }, { -3, 4 }, { 3, 4 },
+    { -1, -5 }, { -5, -1 }, { -5, 1 }, { -1, 5 }, { -2, -5 }, { 2, -5 }, { 5, -2 }, { 5, 2 },
+    { -4, -4 }, { -4, 4 }, { -3, -5 }, { -5, -3 }, { -5, 3 }, { 3, 5 }, { -6, 0 }, { 0, 6 },
+    { -6, -1 }, { -6, 1 }, { 1, 6 }, { 2, -6 }, { -6, 2 }, { 2, 6 }, { -5, -4 }, { 5, 4 },
+    { 4, 5 }, { -6, -3 }, { 6, 3 }, { -7, 0 }, { -1, -7 }, { 5, -5 }, { -7, 1 }, { -1, 7 },
+    { 4, -6 }, { 6, 4 }, { -2, -7 }, { -7, 2 }, { -3, -7 }, { 7, -3 }, { 3, 7 }, { 6, -5 },
+    { 0, -8 }, { -1, -8 }, { -7, -4 }, { -8, 1 }, { 4, 7 }, { 2, -8 }, { -2, 8 }, { 6, 6 },
+    { -8, 3 }, { 5, -7 }, { -5, 7 }, { 8, -4 }, { 0, -9 }, { -9, -1 }, { 1, 9 }, { 7, -6 },
+    { -7, 6 }, { -5, -8 }, { -5, 8 }, { -9, 3 }, { 9, -4 }, { 7, -7 }, { 8, -6 }, { 6, 8 },
+    { 10, 1 }, { -10, 2 }, { 9, -5 }, { 10, -3 }, { -8, -7 }, { -10, -4 }, { 6, -9 }, { -11, 0 },
+    { 11, 1 }, { -11, -2 }, { -2, 11 }, { 7, -10 }, { -7, 10 }, { 10, -7 }, { -4, -11 }, { 11, -4 },
+    { -3, 12 }, { -9, 9 }, { 9, 9 }, { -12, -5 }, { -13, 0 }, { 0, -13 }, { 1, -13 }, { -4, -13 },
+    { 13, 4 }, { 2, -14 }, { -7, 12 }, { -12, -7 }, { -5, 13 }, { -6, 13 }, { -13, -6 }, { 4, -14 },
+    { 0, 15 }, { -9, 12 }, { -15, -2 }, { 7, 14 }, { -1, 16 }, { -7, -14 }, { -15, 6 }, { -12, -11 },
+    { -16, 1 }, { 9, -13 }, { -3, -16 }, { 16, -5 }, { 8, 15 }, { -6, 16 }, { -8, -15 }, { -10, 14 },
+    { 18, 0 }, { 0, 18 }, { 17, -6 }, { -13, -12 }, { 9, -16 }, { 15, 12 }, { -3, -19 }, { 4, 19 },
+    { -19, 5 }, { 16, -11 }, { -20, 0 }, { -16, -12 }, { 9, 18 }, { -13, 16 }, { 21, -1 }, { -18, -11 },
+    { -5, -21 }, { 22, 3 }, { 11, 19 }, { -21, 10 }, { 17, -15 }, { -23, 0 }, { -4, 23 }, { -14, -19 },
+    { 16, 19 }, { 24, -6 }, { -22, -12 }, { 7, -25 }, { -26, 1 }, { 19, 18 }, { -1, 27 }, { -21, -17 },
+    { 27, -8 }, { 12, -26 }, { -28, -6 }, { -10, 28 }, { 25, 15 }, { -29, 10 }, { -5, -30 }, { 22, -21 },
+    { 31, 3 }, { -20, 24 }, { 9, 31 }, { -31, -13 }, { 17, -29 }, { 33, -4 }, { -26, -22 }, { -3, 34 },
+    { 30, 18 }, { -35, 7 }, { 12, -34 }, { 25, 27 }, { -36, -13 }, { -8, -37 }, { 36, -15 }, { -24, 31 },
+    { 39, 4 }, { -33, -25 }, { 19, 37 }, { -2, -41 }, { -41, 16 }, { 34, -28 }, { 43, 8 }, { -15, 44 },
+    { -45, -20 }, { 27, 39 }, { -47, 1 }, { 11, -48 }, { 45, 23 }, { -36, 36 }, { -6, 50 }, { -50, -14 },
+};
+
+uint32_t readLe32(std::span<const uint8_t> data, size_t offset)
+{
+    return uint32_t(data[offset]) | (uint32_t(data[offset + 1]) << 8)
+        | (uint32_t(data[offset + 2]) << 16) | (uint32_t(data[offset + 3]) << 24);
+}
+
+/*
+ * Most significant bit first reader, reads past the end return zeros
+ */
+class FxmBitReader {
+public:
+    void reset(const uint8_t* data, size_t size)
+    {
+        m_data = data;
+        m_size = size;
+        m_position = 0;
+    }
+
+    uint32_t peek() const
+    {
+        size_t byte = m_position >> 3;
+        uint64_t value = 0;
+        if (byte + 8 <= m_size) {
+            std::memcpy(&value, m_data + byte, 8);
+            if constexpr (std::endian::native == std::endian::little) {
+                value = std::byteswap(value);
+            }
+        } else {
+            for (size_t i = 0; i < 8; ++i) {
+                value = (value << 8) | (byte + i < m_size ? m_data[byte + i] : 0);
+            }
+        }
+
+        return uint32_t((value << (m_position & 7)) >> 32);
+    }
+
+    void skip(int count)
+    {
+        m_position += count;
+    }
+
+    // JPEG style signed value, count in [1, 16]
+    int readSigned(int count)
+    {
+        uint32_t value = peek() >> (32 - count);
+        skip(count);
+
+        return (value >> (count - 1)) ? int(value) : int(value) - (1 << count) + 1;
+    }
+
+    int64_t bitsLeft() const
+    {
+        return int64_t(m_size) * 8 - int64_t(m_position);
+    }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_position = 0;
+};
+
+/*
+ * Little endian byte reader for the pfrm word and byte streams
+ */
+class FxmByteReader {
+public:
+    void reset(const uint8_t* data, size_t size)
+    {
+        m_data = data;
+        m_size = size;
+        m_position = 0;
+    }
+
+    size_t bytesLeft() const
+    {
+        return m_size - m_position;
+    }
+
+    // Callers check bytesLeft first
+    uint8_t readByte()
+    {
+        return m_data[m_position++];
+    }
+
+    uint16_t readLe16()
+    {
+        uint16_t value = uint16_t(m_data[m_position] | (m_data[m_position + 1] << 8));
+        m_position += 2;
+
+        return value;
+    }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_position = 0;
+};
+
+int multiply(int value, int constant)
+{
+    return int(unsigned(value) * unsigned(constant)) >> 16;
+}
+
+void idctScalar(int16_t block[64])
+{
+    int temp[64];
+
+    for (int i = 0; i < 8; ++i) {
+        int tmp10 = block[8 * 0 + i] + block[8 * 4 + i];
+        int tmp11 = block[8 * 0 + i] - block[8 * 4 + i];
+
+        int tmp13 = block[8 * 2 + i] + block[8 * 6 + i];
+        int tmp12 = multiply(block[8 * 2 + i] - block[8 * 6 + i], FIX_1_414213562) - tmp13;
+
+        int tmp0 = tmp10 + tmp13;
+        int tmp3 = tmp10 - tmp13;
+        int tmp1 = tmp11 + tmp12;
+        int tmp2 = tmp11 - tmp12;
+
+        int z13 = block[8 * 5 + i] + block[8 * 3 + i];
+        int z10 = block[8 * 5 + i] - block[8 * 3 + i];
+        int z11 = block[8 * 1 + i] + block[8 * 7 + i];
+        int z12 = block[8 * 1 + i] - block[8 * 7 + i];
+
+        int tmp7 = z11 + z13;
+        tmp11 = multiply(z11 - z13, FIX_1_414213562);
+
+        int z5 = multiply(z10 + z12, FIX_1_847759065);
+        tmp10 = multiply(z12, FIX_1_082392200) - z5;
+        tmp12 = multiply(z10, -FIX_2_613125930) + z5;
+
+        int tmp6 = tmp12 - tmp7;
+        int tmp5 = tmp11 - tmp6;
+        int tmp4 = tmp10 + tmp5;
+
+        temp[8 * 0 + i] = tmp0 + tmp7;
+        temp[8 * 7 + i] = tmp0 - tmp7;
+        temp[8 * 1 + i] = tmp1 + tmp6;
+        temp[8 * 6 + i] = tmp1 - tmp6;
+        temp[8 * 2 + i] = tmp2 + tmp5;
+        temp[8 * 5 + i] = tmp2 - tmp5;
+        temp[8 * 4 + i] = tmp3 + tmp4;
+        temp[8 * 3 + i] = tmp3 - tmp4;
+    }
+
+    for (int i = 0; i < 64; i += 8) {
+        int tmp10 = temp[0 + i] + temp[4 + i];
+        int tmp11 = temp[0 + i] - temp[4 + i];
+
+        int tmp13 = temp[2 + i] + temp[6 + i];
+        int tmp12 = multiply(temp[2 + i] - temp[6 + i], FIX_1_414213562) - tmp13;
+
+        int tmp0 = tmp10 + tmp13;
+        int tmp3 = tmp10 - tmp13;
+        int tmp1 = tmp11 + tmp12;
+        int tmp2 = tmp11 - tmp12;
+
+        int z13 = temp[5 + i] + temp[3 + i];
+        int z10 = temp[5 + i] - temp[3 + i];
+        int z11 = temp[1 + i] + temp[7 + i];
+        int z12 = temp[1 + i] - temp[7 + i];
+
+        int tmp7 = z11 + z13;
+        tmp11 = multiply(z11 - z13, FIX_1_414213562);
+
+        int z5 = multiply(z10 + z12, FIX_1_847759065);
+        tmp10 = multiply(z12, FIX_1_082392200) - z5;
+        tmp12 = multiply(z10, -FIX_2_613125930) + z5;
+
+        int tmp6 = tmp12 - tmp7;
+        int tmp5 = tmp11 - tmp6;
+        int tmp4 = tmp10 + tmp5;
+
+        block[0 + i] = (tmp0 + tmp7) >> 6;
+        block[7 + i] = (tmp0 - tmp7) >> 6;
+        block[1 + i] = (tmp1 + tmp6) >> 6;
+        block[6 + i] = (tmp1 - tmp6) >> 6;
+        block[2 + i] = (tmp2 + tmp5) >> 6;
+        block[5 + i] = (tmp2 - tmp5) >> 6;
+        block[4 + i] = (tmp3 + tmp4) >> 6;
+        block[3 + i] = (tmp3 - tmp4) >> 6;
+    }
+}
+
+void convertRowScalar(const int16_t* luma, const int16_t* cbRow, const int16_t* crRow, uint16_t* out)
+{
+    // y = (b + 4g + 2r) / 14, cb = (3b - 2g - r) / 14, cr = (-b - 4g + 5r) / 14
+    for (int x = 0; x < 16; ++x) {
+        int y = luma[(x >> 3) * 64 + (x & 7)];
+        int cb = cbRow[x >> 1];
+        int cr = crRow[x >> 1];
+        int cg = (cb + cr) >> 1;
+        cb += cb;
+
+        out[x] = ((y + cb) >> 3) + (((y - cg) & 0xFC) << 3) + (((y + cr) & 0xF8) << 8);
+    }
+}
+
+/*
+ * Pixels are processed in pairs with 32 bits arithmetic like the original decoder,
+ * so dc carries over from the left pixel to the right one.
+ * The source is ignored when copy is false.
+ */
+void motionCompensateScalar(uint16_t* dst, const uint16_t* src, int log2w, int height, int stride, bool copy, uint16_t dc)
+{
+    int width = 1 << log2w;
+    uint32_t dcPair = uint32_t(dc) * 0x10001;
+
+    for (int row = 0; row < height; ++row) {
+        if (log2w == 0) {
+            dst[0] = copy ? uint16_t(src[0] + dc) : dc;
+        } else {
+            for (int x = 0; x < width; x += 2) {
+                uint32_t pair = copy ? (src[x] | (uint32_t(src[x + 1]) << 16)) + dcPair : dcPair;
+                dst[x] = uint16_t(pair);
+                dst[x + 1] = uint16_t(pair >> 16);
+            }
+        }
+
+        dst += stride;
+        src += copy ? stride : 0;
+    }
+}
+
+#ifdef OFNX_SIMD_SSE2
+void motionCompensateSse2(uint16_t* dst, const uint16_t* src, int log2w, int height, int stride, bool copy, uint16_t dc)
+{
+    if (log2w < 2) {
+        motionCompensateScalar(dst, src, log2w, height, stride, copy, dc);
+        return;
+    }
+
+    __m128i dcPairs = _mm_set1_epi32(int(uint32_t(dc) * 0x10001));
+    for (int row = 0; row < height; ++row) {
+        if (log2w == 3) {
+            __m128i pixels = copy ? _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), dcPairs) : dcPairs;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), pixels);
+        } else {
+            __m128i pixels = copy ? _mm_add_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)), dcPairs) : dcPairs;
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), pixels);
+        }
+
+        dst += stride;
+        src += copy ? stride : 0;
+    }
+}
+
+__m128i mullo32Sse2(__m128i a, __m128i b)
+{
+    // No 32 bits low multiply before SSE4.1, even and odd lanes are multiplied separately
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+__m128i multiplySse2(__m128i value, int constant)
+{
+    return _mm_srai_epi32(mullo32Sse2(value, _mm_set1_epi32(constant)), 16);
+}
+
+// One IDCT pass over 4 lanes, v[k] holds coefficient k of each lane
+void idctPassSse2(__m128i v[8])
+{
+    __m128i tmp10 = _mm_add_epi32(v[0], v[4]);
+    __m128i tmp11 = _mm_sub_epi32(v[0], v[4]);
+
+    __m128i tmp13 = _mm_add_epi32(v[2], v[6]);
+    __m128i tmp12 = _mm_sub_epi32(multiplySse2(_mm_sub_epi32(v[2], v[6]), FIX_1_414213562), tmp13);
+
+    __m128i tmp0 = _mm_add_epi32(tmp10, tmp13);
+    __m128i tmp3 = _mm_sub_epi32(tmp10, tmp13);
+    __m128i tmp1 = _mm_add_epi32(tmp11, tmp12);
+    __m128i tmp2 = _mm_sub_epi32(tmp11, tmp12);
+
+    __m128i z13 = _mm_add_epi32(v[5], v[3]);
+    __m128i z10 = _mm_sub_epi32(v[5], v[3]);
+    __m128i z11 = _mm_add_epi32(v[1], v[7]);
+    __m128i z12 = _mm_sub_epi32(v[1], v[7]);
+
+    __m128i tmp7 = _mm_add_epi32(z11, z13);
+    tmp11 = multiplySse2(_mm_sub_epi32(z11, z13), FIX_1_414213562);
+
+    __m128i z5 = multiplySse2(_mm_add_epi32(z10, z12), FIX_1_847759065);
+    tmp10 = _mm_sub_epi32(multiplySse2(z12, FIX_1_082392200), z5);
+    tmp12 = _mm_add_epi32(multiplySse2(z10, -FIX_2_613125930), z5);
+
+    __m128i tmp6 = _mm_sub_epi32(tmp12, tmp7);
+    __m128i tmp5 = _mm_sub_epi32(tmp11, tmp6);
+    __m128i tmp4 = _mm_add_epi32(tmp10, tmp5);
+
+    v[0] = _mm_add_epi32(tmp0, tmp7);
+    v[7] = _mm_sub_epi32(tmp0, tmp7);
+    v[1] = _mm_add_epi32(tmp1, tmp6);
+    v[6] = _mm_sub_epi32(tmp1, tmp6);
+    v[2] = _mm_add_epi32(tmp2, tmp5);
+    v[5] = _mm_sub_epi32(tmp2, tmp5);
+    v[4] = _mm_add_epi32(tmp3, tmp4);
+    v[3] = _mm_sub_epi32(tmp3, tmp4);
+}
+
+void transpose4x4Sse2(__m128i& a, __m128i& b, __m128i& c, __m128i& d)
+{
+    __m128i ab0 = _mm_unpacklo_epi32(a, b);
+    __m128i cd0 = _mm_unpacklo_epi32(c, d);
+    __m128i ab1 = _mm_unpackhi_epi32(a, b);
+    __m128i cd1 = _mm_unpackhi_epi32(c, d);
+
+    a = _mm_unpacklo_epi64(ab0, cd0);
+    b = _mm_unpackhi_epi64(ab0, cd0);
+    c = _mm_unpacklo_epi64(ab1, cd1);
+    d = _mm_unpackhi_epi64(ab1, cd1);
+}
+
+// 8x8 matrix stored as left (columns 0-3) and right (columns 4-7) halves of each row
+void transpose8x8Sse2(__m128i left[8], __m128i right[8])
+{
+    transpose4x4Sse2(left[0], left[1], left[2], left[3]);
+    transpose4x4Sse2(right[0], right[1], right[2], right[3]);
+    transpose4x4Sse2(left[4], left[5], left[6], left[7]);
+    transpose4x4Sse2(right[4], right[5], right[6], right[7]);
+
+    for (int i = 0; i < 4; ++i) {
+        std::swap(right[i], left[i + 4]);
+    }
+}
+
+void idctSse2(int16_t block[64])
+{
+    __m128i left[8];
+    __m128i right[8];
+    for (int row = 0; row < 8; ++row) {
+        __m128i values = _mm_load_si128(reinterpret_cast<const __m128i*>(block + 8 * row));
+        left[row] = _mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16);
+        right[row] = _mm_srai_epi32(_mm_unpackhi_epi16(values, values), 16);
+    }
+
+    // Columns are processed in parallel, then rows once transposed
+    idctPassSse2(left);
+    idctPassSse2(right);
+    transpose8x8Sse2(left, right);
+    idctPassSse2(left);
+    idctPassSse2(right);
+    transpose8x8Sse2(left, right);
+
+    for (int row = 0; row < 8; ++row) {
+        // Truncate to 16 bits like the scalar stores, packs would saturate
+        __m128i low = _mm_srai_epi32(_mm_slli_epi32(_mm_srai_epi32(left[row], 6), 16), 16);
+        __m128i high = _mm_srai_epi32(_mm_slli_epi32(_mm_srai_epi32(right[row], 6), 16), 16);
+        _mm_store_si128(reinterpret_cast<__m128i*>(block + 8 * row), _mm_packs_epi32(low, high));
+    }
+}
+
+__m128i convertPixelsSse2(__m128i y, __m128i cb, __m128i cg, __m128i cr)
+{
+    __m128i b = _mm_srai_epi16(_mm_add_epi16(y, cb), 3);
+    __m128i g = _mm_slli_epi16(_mm_and_si128(_mm_sub_epi16(y, cg), _mm_set1_epi16(0xFC)), 3);
+    __m128i r = _mm_slli_epi16(_mm_and_si128(_mm_add_epi16(y, cr), _mm_set1_epi16(0xF8)), 8);
+
+    return _mm_add_epi16(_mm_add_epi16(b, g), r);
+}
+
+void convertRowSse2(const int16_t* luma, const int16_t* cbRow, const int16_t* crRow, uint16_t* out)
+{
+    __m128i cb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cbRow));
+    __m128i cr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(crRow));
+
+    // Floor of (cb + cr) / 2 without 16 bits overflow
+    __m128i cg = _mm_add_epi16(_mm_and_si128(cb, cr), _mm_srai_epi16(_mm_xor_si128(cb, cr), 1));
+    cb = _mm_add_epi16(cb, cb);
+
+    // Chroma is subsampled, each value covers 2 pixels
+    __m128i y0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(luma));
+    __m128i y1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(luma + 64));
+    __m128i pixels0 = convertPixelsSse2(y0, _mm_unpacklo_epi16(cb, cb), _mm_unpacklo_epi16(cg, cg), _mm_unpacklo_epi16(cr, cr));
+    __m128i pixels1 = convertPixelsSse2(y1, _mm_unpackhi_epi16(cb, cb), _mm_unpackhi_epi16(cg, cg), _mm_unpackhi_epi16(cr, cr));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), pixels0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), pixels1);
+}
+#endif
+
+void idct(int16_t block[64])
+{
+#ifdef OFNX_SIMD_SSE2
+    idctSse2(block);
+#else
+    idctScalar(block);
+#endif
+}
+
+void motionCompensate(uint16_t* dst, const uint16_t* src, int log2w, int height, int stride, bool copy, uint16_t dc)
+{
+#ifdef OFNX_SIMD_SSE2
+    motionCompensateSse2(dst, src, log2w, height, stride, copy, dc);
+#else
+    motionCompensateScalar(dst, src, log2w, height, stride, copy, dc);
+#endif
+}
+
+void convertRow(const int16_t* luma, const int16_t* cbRow, const int16_t* crRow, uint16_t* out)
+{
+#ifdef OFNX_SIMD_SSE2
+    convertRowSse2(luma, cbRow, crRow, out);
+#else
+    convertRowScalar(luma, cbRow, crRow, out);
+#endif
+}
+
+/* PRIVATE */
+class FxmDecoder::Impl {
+    friend class FxmDecoder;
+
+public:
+    struct VlcEntry {
+        int32_t symbol; // Sub table offset if length is negative
+        int32_t length; // Code length, 0 if invalid, -(sub table bits) for long code prefixes
+    };
+
+    size_t readHuffmanTables(std::span<const uint8_t> data);
+    bool buildVlc(const uint8_t lengths[FXM_VLC_SYMBOL_COUNT], const uint32_t codes[FXM_VLC_SYMBOL_COUNT]);
+    int readSymbol();
+
+    bool decodeBlock(int16_t block[64]);
+    bool decodeMacroblock();
+    void putMacroblock(int x, int y);
+
+    void initMotionVectors();
+    bool decodePredictedBlock(size_t dstOffset, ptrdiff_t srcOffset, int log2w, int log2h);
+
+private:
+    int m_width = 0;
+    int m_height = 0;
+    int m_version = 0;
+
+    std::vector<uint16_t> m_frame; // Last decoded frame, reference for predicted frames
+    std::vector<uint16_t> m_nextFrame; // Frame being decoded, swapped with m_frame on success
+
+    // Retained between frames
+    std::vector<VlcEntry> m_vlc;
+    std::vector<uint8_t> m_prefixBuffer;
+    std::vector<uint8_t> m_bitstreamBuffer;
+    std::array<int, 256> m_motionOffsets {};
+
+    FxmByteReader m_wordReader;
+    FxmByteReader m_byteReader;
+
+    FxmBitReader m_prefixReader;
+    FxmBitReader m_bitReader;
+    int m_lastDc = 0;
+
+    alignas(16) int16_t m_blocks[6][64]; // 4 luma, then cb and cr
+};
+
+/**
+ * Builds the prefix code from the symbol frequency table.
+ * @return The table size, aligned to 4 bytes (0 if invalid).
+ */
+size_t FxmDecoder::Impl::readHuffmanTables(std::span<const uint8_t> data)
+{
+    int frequency[512] = { 0 };
+    uint8_t flag[512] = { 0 };
+    int up[512];
+    std::fill(std::begin(up), std::end(up), -1);
+
+    // Frequencies are stored as [start, end] ranges, a zero start ends the list
+    size_t offset = 0;
+    if (data.size() < 2) {
+        LOG_ERROR("Invalid Huffman table");
+        return 0;
+    }
+
+    int start = data[offset++];
+    int end = data[offset++];
+    while (true) {
+        if (data.size() - offset < size_t(std::max(end - start + 1, 0)) + 1) {
+            LOG_ERROR("Invalid Huffman table");
+            return 0;
+        }
+
+        for (int i = start; i <= end; ++i) {
+            frequency[i] = data[offset++];
+        }
+
+        start = data[offset++];
+        if (start == 0) {
+            break;
+        }
+
+        if (offset >= data.size()) {
+            LOG_ERROR("Invalid Huffman table");
+            return 0;
+        }
+        end = data[offset++];
+    }
+    frequency[FXM_VLC_END_OF_STREAM] = 1;
+
+    offset = (offset + 3) & ~size_t(3);
+    if (offset > data.size()) {
+        LOG_ERROR("Invalid Huffman table");
+        return 0;
+    }
+
+    // Merge the two least frequent nodes until one is left (ties go to the lowest index)
+    for (int node = FXM_VLC_SYMBOL_COUNT; node < 512; ++node) {
+        int minFrequency[2] = { 256 * 256, 256 * 256 };
+        int smallest[2] = { 0, 0 };
+        for (int i = 0; i < node; ++i) {
+            if (frequency[i] == 0) {
+                continue;
+            }
+
+            if (frequency[i] < minFrequency[1]) {
+                if (frequency[i] < minFrequency[0]) {
+                    minFrequency[1] = minFrequency[0];
+                    smallest[1] = smallest[0];
+                    minFrequency[0] = frequency[i];
+                    smallest[0] = i;
+                } else {
+                    minFrequency[1] = frequency[i];
+                    smallest[1] = i;
+                }
+            }
+        }
+
+        if (minFrequency[1] == 256 * 256) {
+            break;
+        }
+
+        frequency[node] = minFrequency[0] + minFrequency[1];
+        flag[smallest[0]] = 0;
+        flag[smallest[1]] = 1;
+        up[smallest[0]] = node;
+        up[smallest[1]] = node;
+        frequency[smallest[0]] = 0;
+        frequency[smallest[1]] = 0;
+    }
+
+    uint8_t lengths[FXM_VLC_SYMBOL_COUNT];
+    uint32_t codes[FXM_VLC_SYMBOL_COUNT];
+    for (int symbol = 0; symbol < FXM_VLC_SYMBOL_COUNT; ++symbol) {
+        uint32_t code = 0;
+        int length = 0;
+        for (int node = symbol; up[node] != -1; node = up[node]) {
+            if (length >= FXM_VLC_MAX_LENGTH) {
+                LOG_ERROR("Huffman code too long");
+                return 0;
+            }
+
+            code |= uint32_t(flag[node]) << length;
+            ++length;
+        }
+
+        codes[symbol] = code;
+        lengths[symbol] = length;
+    }
+
+    if (!buildVlc(lengths, codes)) {
+        return 0;
+    }
+
+    return offset;
+}
+
+bool FxmDecoder::Impl::buildVlc(const uint8_t lengths[FXM_VLC_SYMBOL_COUNT], const uint32_t codes[FXM_VLC_SYMBOL_COUNT])
+{
+    constexpr int primarySize = 1 << FXM_VLC_BITS;
+
+    // Size sub tables for codes longer than the primary lookup
+    std::array<int, primarySize> subBits {};
+    for (int symbol = 0; symbol < FXM_VLC_SYMBOL_COUNT; ++symbol) {
+        int length = lengths[symbol];
+        if (length > FXM_VLC_BITS) {
+            int prefix = codes[symbol] >> (length - FXM_VLC_BITS);
+            subBits[prefix] = std::max(subBits[prefix], length - FXM_VLC_BITS);
+        }
+    }
+
+    m_vlc.assign(primarySize, { 0, 0 });
+    for (int prefix = 0; prefix < primarySize; ++prefix) {
+        if (subBits[prefix] > 0) {
+            m_vlc[prefix] = { int32_t(m_vlc.size()), -subBits[prefix] };
+            m_vlc.resize(m_vlc.size() + (size_t(1) << subBits[prefix]), { 0, 0 });
+        }
+    }
+
+    for (int symbol = 0; symbol < FXM_VLC_SYMBOL_COUNT; ++symbol) {
+        int length = lengths[symbol];
+        uint32_t code = codes[symbol];
+        if (length == 0) {
+            continue;
+        }
+
+        size_t first;
+        size_t count;
+        int entryLength;
+        if (length <= FXM_VLC_BITS) {
+            first = size_t(code) << (FXM_VLC_BITS - length);
+            count = size_t(1) << (FXM_VLC_BITS - length);
+            entryLength = length;
+        } else {
+            int rest = length - FXM_VLC_BITS;
+            const VlcEntry& table = m_vlc[code >> rest];
+            int tableBits = -table.length;
+            first = table.symbol + (size_t(code & ((1u << rest) - 1)) << (tableBits - rest));
+            count = size_t(1) << (tableBits - rest);
+            entryLength = rest;
+        }
+
+        for (size_t i = first; i < first + count; ++i) {
+            if (m_vlc[i].length < 0) {
+                LOG_ERROR("Invalid Huffman code");
+                return false;
+            }
+
+            m_vlc[i] = { symbol, entryLength };
+        }
+    }
+
+    return true;
+}
+
+int FxmDecoder::Impl::readSymbol()
+{
+    uint32_t bits = m_prefixReader.peek();
+    VlcEntry entry = m_vlc[bits >> (32 - FXM_VLC_BITS)];
+
+    if (entry.length < 0) {
+        int tableBits = -entry.length;
+        entry = m_vlc[entry.symbol + ((bits << FXM_VLC_BITS) >> (32 - tableBits))];
+        if (entry.length <= 0) {
+            return -1;
+        }
+
+        m_prefixReader.skip(FXM_VLC_BITS + entry.length);
+        return entry.symbol;
+    }
+
+    if (entry.length == 0) {
+        return -1;
+    }
+
+    m_prefixReader.skip(entry.length);
+    return entry.symbol;
+}
+
+bool FxmDecoder::Impl::decodeBlock(int16_t block[64])
+{
+    if (m_prefixReader.bitsLeft() < 2) {
+        LOG_ERROR("Prefix stream overrun");
+        return false;
+    }
+
+    // DC coefficient, predicted from the previous block of any component
+    int value = readSymbol();
+    if (value < 0 || (value >> 4) != 0) {
+        LOG_ERROR("Invalid DC code");
+        return false;
+    }
+
+    if (value != 0) {
+        value = m_bitReader.readSigned(value);
+    }
+
+    block[0] = value * DEQUANT[0] + m_lastDc;
+    m_lastDc = block[0];
+
+    // AC coefficients, codes are (run << 4) | size
+    for (int i = 1;;) {
+        int code = readSymbol();
+        if (code < 0) {
+            LOG_ERROR("Invalid AC code");
+            return false;
+        }
+
+        if (code == 0) {
+            // End of block
+            break;
+        }
+
+        if (code == 0xF0) {
+            i += 16;
+            if (i >= 64) {
+                LOG_WARN("AC run overflow");
+                break;
+            }
+            continue;
+        }
+
+        if ((code & 0xF) == 0) {
+            LOG_ERROR("Invalid AC coefficient");
+            return false;
+        }
+
+        int level = m_bitReader.readSigned(code & 0xF);
+        i += code >> 4;
+        if (i >= 64) {
+            LOG_WARN("AC run overflow");
+            break;
+        }
+
+        int index = ZIGZAG[i];
+        block[index] = level * DEQUANT[index];
+        if (++i >= 64) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool FxmDecoder::Impl::decodeMacroblock()
+{
+    std::memset(m_blocks, 0, sizeof(m_blocks));
+
+    for (auto& block : m_blocks) {
+        if (!decodeBlock(block)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void FxmDecoder::Impl::putMacroblock(int x, int y)
+{
+    for (int i = 0; i < 4; ++i) {
+        m_blocks[i][0] += 0x80 * 8 * 8;
+        idct(m_blocks[i]);
+    }
+    idct(m_blocks[4]);
+    idct(m_blocks[5]);
+
+    uint16_t* out = m_nextFrame.data() + y * m_width + x;
+    for (int row = 0; row < 16; ++row) {
+        const int16_t* luma = m_blocks[2 * (row >> 3)] + 8 * (row & 7);
+        const int16_t* cb = m_blocks[4] + 8 * (row >> 1);
+        const int16_t* cr = m_blocks[5] + 8 * (row >> 1);
+        convertRow(luma, cb, cr, out + row * m_width);
+    }
+}
+
+void FxmDecoder::Impl::initMotionVectors()
+{
+    for (int i = 0; i < 256; ++i) {
+        if (m_version > 1) {
+            m_motionOffsets[i] = MOTION_VECTORS[i][0] + MOTION_VECTORS[i][1] * m_width;
+        } else {
+            m_motionOffsets[i] = (i & 15) - 8 + ((i >> 4) - 8) * m_width;
+        }
+    }
+}
+
+/**
+ * Block types: 0 motion vector copy, 1 horizontal split, 2 vertical split, 3 unchanged,
+ * 4 motion vector copy plus dc, 5 dc fill, 6 two literal pixels
+ */
+bool FxmDecoder::Impl::decodePredictedBlock(size_t dstOffset, ptrdiff_t srcOffset, int log2w, int log2h)
+{
+    if (m_bitReader.bitsLeft() < 1) {
+        LOG_ERROR("pfrm bitstream overrun");
+        return false;
+    }
+
+    int shape = BLOCK_SHAPES[log2h][log2w];
+    BlockTypeEntry entry = BLOCK_TYPE_LOOKUP[m_version > 1 ? 0 : 1][shape][m_bitReader.peek() >> (32 - FXM_BLOCK_TYPE_BITS)];
+    if (entry.length == 0) {
+        LOG_ERROR("Invalid pfrm block type");
+        return false;
+    }
+    m_bitReader.skip(entry.length);
+
+    int height = 1 << log2h;
+    switch (entry.type) {
+    case 1:
+        --log2h;
+        return decodePredictedBlock(dstOffset, srcOffset, log2w, log2h)
+            && decodePredictedBlock(dstOffset + (m_width << log2h), srcOffset + (m_width << log2h), log2w, log2h);
+    case 2:
+        --log2w;
+        return decodePredictedBlock(dstOffset, srcOffset, log2w, log2h)
+            && decodePredictedBlock(dstOffset + (1 << log2w), srcOffset + (1 << log2w), log2w, log2h);
+    case 3:
+        // Version 2 streams leave the block as it was two frames ago
+        if (m_version > 1) {
+            return true;
+        }
+        break;
+    case 6:
+        if (m_wordReader.bytesLeft() < 4) {
+            LOG_ERROR("pfrm word stream overrun");
+            return false;
+        }
+
+        m_nextFrame[dstOffset] = m_wordReader.readLe16();
+        m_nextFrame[dstOffset + (log2w ? 1 : m_width)] = m_wordReader.readLe16();
+        return true;
+    default:
+        break;
+    }
+
+    bool copy = entry.type != 5;
+    uint16_t dc = 0;
+    if (entry.type == 0 || entry.type == 4) {
+        if (m_byteReader.bytesLeft() < 1) {
+            LOG_ERROR("pfrm byte stream overrun");
+            return false;
+        }
+        srcOffset += m_motionOffsets[m_byteReader.readByte()];
+    }
+    if (entry.type == 4 || entry.type == 5) {
+        if (m_wordReader.bytesLeft() < 2) {
+            LOG_ERROR("pfrm word stream overrun");
+            return false;
+        }
+        dc = m_wordReader.readLe16();
+    }
+
+    // Vectors may wrap horizontally but must stay inside the frame
+    ptrdiff_t srcEnd = ptrdiff_t(m_width) * (m_height - height + 1) - (1 << log2w);
+    if (srcOffset < 0 || srcOffset > srcEnd) {
+        LOG_ERROR("pfrm motion vector out of frame");
+        return false;
+    }
+
+    motionCompensate(m_nextFrame.data() + dstOffset, m_frame.data() + srcOffset, log2w, height, m_width, copy, dc);
+
+    return true;
+}
+
+/* PUBLIC */
+FxmDecoder::FxmDecoder()
+{
+    d_ptr = new Impl;
+}
+
+FxmDecoder::~FxmDecoder()
+{
+    delete d_ptr;
+}
+
+bool FxmDecoder::init(int width, int height, int version)
+{
+    if (width <= 0 || height <= 0 || width % 16 != 0 || height % 16 != 0 || width > 4096 || height > 4096) {
+        LOG_ERROR("Unsupported frame size: {}x{}", width, height);
+        d_ptr->m_width = 0;
+        d_ptr->m_height = 0;
+        d_ptr->m_frame.clear();
+        d_ptr->m_nextFrame.clear();
+        return false;
+    }
+
+    d_ptr->m_width = width;
+    d_ptr->m_height = height;
+    d_ptr->m_version = version;
+    d_ptr->m_frame.assign(width * height, 0);
+    d_ptr->m_nextFrame.assign(width * height, 0);
+    d_ptr->initMotionVectors();
+
+    return true;
+}
+
+int FxmDecoder::getWidth() const
+{
+    return d_ptr->m_width;
+}
+
+int FxmDecoder::getHeight() const
+{
+    return d_ptr->m_height;
+}
+
+int FxmDecoder::getVersion() const
+{
+    return d_ptr->m_version;
+}
+
+bool FxmDecoder::decodeIntraFrame(std::span<const uint8_t> data)
+{
+    if (d_ptr->m_frame.empty()) {
+        LOG_ERROR("Decoder not initialized");
+        return false;
+    }
+
+    // Layout: bitstream size, bitstream, prefix stream size / 4, token count, prefix stream
+    if (data.size() < 12) {
+        LOG_ERROR("ifrm chunk too small");
+        return false;
+    }
+
+    uint32_t bitstreamSize = readLe32(data, 0);
+    if (bitstreamSize > FXM_MAX_STREAM_SIZE || data.size() < bitstreamSize + 12) {
+        LOG_ERROR("Invalid ifrm bitstream size");
+        return false;
+    }
+
+    uint32_t prefixSize = readLe32(data, bitstreamSize + 4);
+    if (prefixSize > FXM_MAX_STREAM_SIZE / 4 || prefixSize * 4 + bitstreamSize + 12 != data.size()) {
+        LOG_ERROR("Invalid ifrm prefix stream size");
+        return false;
+    }
+
+    std::span<const uint8_t> prefixStream = data.subspan(bitstreamSize + 12);
+    size_t tableSize = d_ptr->readHuffmanTables(prefixStream);
+    if (tableSize == 0) {
+        return false;
+    }
+
+    // Prefix codes are read from 32 bits little endian words
+    std::span<const uint8_t> prefixCodes = prefixStream.subspan(tableSize);
+    d_ptr->m_prefixBuffer.resize(prefixCodes.size() & ~size_t(3));
+    for (size_t i = 0; i < d_ptr->m_prefixBuffer.size(); i += 4) {
+        d_ptr->m_prefixBuffer[i] = prefixCodes[i + 3];
+        d_ptr->m_prefixBuffer[i + 1] = prefixCodes[i + 2];
+        d_ptr->m_prefixBuffer[i + 2] = prefixCodes[i + 1];
+        d_ptr->m_prefixBuffer[i + 3] = prefixCodes[i];
+    }
+
+    d_ptr->m_prefixReader.reset(d_ptr->m_prefixBuffer.data(), d_ptr->m_prefixBuffer.size());
+    d_ptr->m_bitReader.reset(data.data() + 4, bitstreamSize);
+    d_ptr->m_lastDc = 0;
+
+    for (int y = 0; y < d_ptr->m_height; y += 16) {
+        for (int x = 0; x < d_ptr->m_width; x += 16) {
+            if (!d_ptr->decodeMacroblock()) {
+                return false;
+            }
+
+            d_ptr->putMacroblock(x, y);
+        }
+    }
+
+    if (d_ptr->readSymbol() != FXM_VLC_END_OF_STREAM) {
+        LOG_WARN("ifrm end of stream mismatch");
+    }
+
+    std::swap(d_ptr->m_frame, d_ptr->m_nextFrame);
+
+    return true;
+}
+
+bool FxmDecoder::decodePredictedFrame(std::span<const uint8_t> data, uint32_t streamSizes)
+{
+    if (d_ptr->m_frame.empty()) {
+        LOG_ERROR("Decoder not initialized");
+        return false;
+    }
+
+    // Layout: [unknown (8), bitstream size, word stream size, byte stream size], bitstream, word stream, byte stream
+    size_t length = data.size();
+    size_t headerSize;
+    size_t bitstreamSize;
+    size_t wordStreamSize;
+    size_t byteStreamSize;
+    if (d_ptr->m_version > 1) {
+        headerSize = 20;
+        if (length < headerSize) {
+            LOG_ERROR("pfrm chunk too small");
+            return false;
+        }
+
+        bitstreamSize = readLe32(data, 8);
+        wordStreamSize = readLe32(data, 12);
+        byteStreamSize = readLe32(data, 16);
+    } else {
+        // Version 1 sizes are stored in the chunk first word
+        headerSize = 0;
+        bitstreamSize = streamSizes & 0xFFFF;
+        wordStreamSize = streamSizes >> 16;
+        byteStreamSize = length - std::min(length, bitstreamSize + wordStreamSize);
+    }
+
+    if (bitstreamSize > length || bitstreamSize > FXM_MAX_STREAM_SIZE
+        || byteStreamSize > length - bitstreamSize
+        || wordStreamSize > length - bitstreamSize - byteStreamSize
+        || headerSize > length - bitstreamSize - byteStreamSize - wordStreamSize) {
+        LOG_ERROR("Invalid pfrm stream sizes");
+        return false;
+    }
+
+    // Block types are read from 32 bits little endian words
+    std::span<const uint8_t> bitstream = data.subspan(headerSize, bitstreamSize);
+    d_ptr->m_bitstreamBuffer.assign(bitstreamSize, 0);
+    for (size_t i = 0; i + 4 <= bitstreamSize; i += 4) {
+        d_ptr->m_bitstreamBuffer[i] = bitstream[i + 3];
+        d_ptr->m_bitstreamBuffer[i + 1] = bitstream[i + 2];
+        d_ptr->m_bitstreamBuffer[i + 2] = bitstream[i + 1];
+        d_ptr->m_bitstreamBuffer[i + 3] = bitstream[i];
+    }
+    d_ptr->m_bitReader.reset(d_ptr->m_bitstreamBuffer.data(), bitstreamSize);
+
+    size_t wordStreamOffset = headerSize + bitstreamSize;
+    size_t byteStreamOffset = wordStreamOffset + wordStreamSize;
+    d_ptr->m_wordReader.reset(data.data() + wordStreamOffset, length - wordStreamOffset);
+    d_ptr->m_byteReader.reset(data.data() + byteStreamOffset, length - byteStreamOffset);
+
+    for (int y = 0; y < d_ptr->m_height; y += 8) {
+        for (int x = 0; x < d_ptr->m_width; x += 8) {
+            size_t offset = size_t(y) * d_ptr->m_width + x;
+            if (!d_ptr->decodePredictedBlock(offset, ptrdiff_t(offset), 3, 3)) {
+                return false;
+            }
+        }
+    }
+
+    std::swap(d_ptr->m_frame, d_ptr->m_nextFrame);
+
+    return true;
+}
+
+std::span<const uint16_t> FxmDecoder::getFrame() const
+{
+    return d_ptr->m_frame;
+}
+
+} // namespace ofnx::graphics
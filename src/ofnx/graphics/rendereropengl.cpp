@@ -24,6 +24,8 @@ SOFTWARE.
 
 #include "ofnx/graphics/rendereropengl.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
 #include <vector>
 
@@ -32,6 +34,7 @@ SOFTWARE.
 #include <glm/gtc/type_ptr.hpp>
 
 #include "glad/gl.h"
+#include "ofnx/graphics/spriteatlas.h"
 #include "ofnx/tools/log.h"
 
 namespace ofnx::graphics {
@@ -40,6 +43,12 @@ namespace ofnx::graphics {
 class RendererOpenGL::Impl {
     friend class RendererOpenGL;
 
+public:
+    struct SpriteInstanceGpu {
+        GLint rect[4]; // Screen x, y, width, height
+        GLint source[4]; // Atlas x, y, page, unused
+    };
+
 public:
     GLuint createShaderProgram(const char* vertexSrc, const char* fragmentSrc);
 
@@ -54,6 +63,15 @@ private:
     GLuint m_vaoFrame;
     GLuint m_vboFrame;
     GLuint m_eboFrame;
+
+    GLuint m_textureSprites = 0;
+    GLuint m_shaderSprites = 0;
+    GLuint m_vaoSprites = 0;
+    GLuint m_vboSpritesQuad = 0;
+    GLuint m_vboSpritesInstances = 0;
+    size_t m_spriteInstanceCapacity = 0;
+    const SpriteAtlas* m_spriteAtlas = nullptr;
+    std::vector<SpriteInstanceGpu> m_spriteInstanceList;
 };
 
 GLuint RendererOpenGL::Impl::createShaderProgram(const char* vertexSrc, const char* fragmentSrc)
@@ -109,6 +127,40 @@ void main() {
 }
 )";
 
+const char* vertexShaderSprites = R"(
+#version 330 core
+layout(location = 0) in vec2 aCorner;
+layout(location = 1) in ivec4 aRect;
+layout(location = 2) in ivec4 aSource;
+out vec2 vTexel;
+flat out ivec4 vBounds;
+flat out int vPage;
+void main() {
+    vec2 pos = vec2(aRect.xy) + aCorner * vec2(aRect.zw);
+    vTexel = vec2(aSource.xy) + aCorner * vec2(aRect.zw);
+    vBounds = ivec4(aSource.xy, aSource.xy + aRect.zw - 1);
+    vPage = aSource.z;
+    gl_Position = vec4(pos.x / 320.0 - 1.0, 1.0 - pos.y / 240.0, 0.0, 1.0);
+}
+)";
+const char* fragmentShaderSprites = R"(
+#version 330 core
+in vec2 vTexel;
+flat in ivec4 vBounds;
+flat in int vPage;
+out vec4 FragColor;
+uniform usampler2DArray atlas;
+uniform int colorKey;
+void main() {
+    ivec2 texel = clamp(ivec2(vTexel), vBounds.xy, vBounds.zw);
+    uint pixel = texelFetch(atlas, ivec3(texel, vPage), 0).r;
+    if (int(pixel) == colorKey) {
+        discard;
+    }
+    FragColor = vec4(float(pixel >> 11) / 31.0, float((pixel >> 5) & 63u) / 63.0, float(pixel & 31u) / 31.0, 1.0);
+}
+)";
+
 glm::vec3 CUBE_VERTICES[26] = {
     glm::vec3 { -1, -1, -1 },
     glm::vec3 { 1, -1, -1 },
@@ -328,6 +380,38 @@ bool RendererOpenGL::init(int width, int height, bool isNewVr, oglLoadFunc oglFc
 
     d_ptr->m_shaderFrame = d_ptr->createShaderProgram(vertexShaderFrame, fragmentShader);
 
+    /* Sprites init */
+    float spriteCorners[] = {
+        0.0f, 0.0f,
+        1.0f, 0.0f,
+        0.0f, 1.0f,
+        1.0f, 1.0f
+    };
+
+    glGenVertexArrays(1, &d_ptr->m_vaoSprites);
+    glBindVertexArray(d_ptr->m_vaoSprites);
+
+    glGenBuffers(1, &d_ptr->m_vboSpritesQuad);
+    glBindBuffer(GL_ARRAY_BUFFER, d_ptr->m_vboSpritesQuad);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(spriteCorners), spriteCorners, GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glGenBuffers(1, &d_ptr->m_vboSpritesInstances);
+    glBindBuffer(GL_ARRAY_BUFFER, d_ptr->m_vboSpritesInstances);
+
+    glVertexAttribIPointer(1, 4, GL_INT, sizeof(Impl::SpriteInstanceGpu), (void*)offsetof(Impl::SpriteInstanceGpu, rect));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribIPointer(2, 4, GL_INT, sizeof(Impl::SpriteInstanceGpu), (void*)offsetof(Impl::SpriteInstanceGpu, source));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    glBindVertexArray(0);
+
+    d_ptr->m_shaderSprites = d_ptr->createShaderProgram(vertexShaderSprites, fragmentShaderSprites);
+
     return true;
 }
 
@@ -349,6 +433,14 @@ void RendererOpenGL::deinit()
         glDeleteTextures(1, &d_ptr->m_textureFrame);
         d_ptr->m_textureFrame = 0;
     }
+    if (d_ptr->m_shaderSprites) {
+        glDeleteProgram(d_ptr->m_shaderSprites);
+        d_ptr->m_shaderSprites = 0;
+    }
+    if (d_ptr->m_textureSprites) {
+        glDeleteTextures(1, &d_ptr->m_textureSprites);
+        d_ptr->m_textureSprites = 0;
+    }
 
     glDeleteVertexArrays(1, &d_ptr->m_vaoVr);
     glDeleteBuffers(1, &d_ptr->m_vboVr);
@@ -357,6 +449,12 @@ void RendererOpenGL::deinit()
     glDeleteVertexArrays(1, &d_ptr->m_vaoFrame);
     glDeleteBuffers(1, &d_ptr->m_vboFrame);
     glDeleteBuffers(1, &d_ptr->m_eboFrame);
+
+    glDeleteVertexArrays(1, &d_ptr->m_vaoSprites);
+    glDeleteBuffers(1, &d_ptr->m_vboSpritesQuad);
+    glDeleteBuffers(1, &d_ptr->m_vboSpritesInstances);
+    d_ptr->m_spriteInstanceCapacity = 0;
+    d_ptr->m_spriteAtlas = nullptr;
 }
 
 void RendererOpenGL::updateVr(unsigned short* vr)
@@ -410,4 +508,88 @@ void RendererOpenGL::renderFrame()
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 }
 
+bool RendererOpenGL::updateSpriteAtlas(const SpriteAtlas& atlas)
+{
+    if (atlas.pageCount() == 0) {
+        LOG_ERROR("Sprite atlas is empty");
+        return false;
+    }
+
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    if (atlas.pageCount() > maxLayers) {
+        LOG_ERROR("Too many sprite atlas pages: {}", atlas.pageCount());
+        return false;
+    }
+
+    if (!d_ptr->m_textureSprites) {
+        glGenTextures(1, &d_ptr->m_textureSprites);
+    }
+
+    // Raw RGB565 values, decoded in the shader so the color key can be compared exactly
+    int size = atlas.pageSize();
+    glBindTexture(GL_TEXTURE_2D_ARRAY, d_ptr->m_textureSprites);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R16UI, size, size, atlas.pageCount(), 0, GL_RED_INTEGER, GL_UNSIGNED_SHORT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    for (int page = 0; page < atlas.pageCount(); ++page) {
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, page, size, size, 1, GL_RED_INTEGER, GL_UNSIGNED_SHORT, atlas.pageData(page));
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    d_ptr->m_spriteAtlas = &atlas;
+
+    return true;
+}
+
+void RendererOpenGL::renderSprites(const std::vector<SpriteInstance>& sprites, int colorKey)
+{
+    if (!d_ptr->m_spriteAtlas || sprites.empty()) {
+        return;
+    }
+
+    // Instance data is rebuilt in a retained buffer, no per-frame allocation once warmed up
+    d_ptr->m_spriteInstanceList.clear();
+    for (const SpriteInstance& sprite : sprites) {
+        SpriteAtlas::Region region = d_ptr->m_spriteAtlas->region(sprite.spriteId);
+        if (region.page < 0) {
+            continue;
+        }
+
+        d_ptr->m_spriteInstanceList.push_back({
+            { sprite.x, sprite.y, region.width, region.height },
+            { region.x, region.y, region.page, 0 },
+        });
+    }
+
+    if (d_ptr->m_spriteInstanceList.empty()) {
+        return;
+    }
+
+    size_t byteSize = d_ptr->m_spriteInstanceList.size() * sizeof(Impl::SpriteInstanceGpu);
+    glBindBuffer(GL_ARRAY_BUFFER, d_ptr->m_vboSpritesInstances);
+    if (byteSize > d_ptr->m_spriteInstanceCapacity) {
+        d_ptr->m_spriteInstanceCapacity = std::max(byteSize, d_ptr->m_spriteInstanceCapacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, d_ptr->m_spriteInstanceCapacity, nullptr, GL_STREAM_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, byteSize, d_ptr->m_spriteInstanceList.data());
+
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glUseProgram(d_ptr->m_shaderSprites);
+    glBindVertexArray(d_ptr->m_vaoSprites);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, d_ptr->m_textureSprites);
+    glUniform1i(glGetUniformLocation(d_ptr->m_shaderSprites, "atlas"), 0);
+    glUniform1i(glGetUniformLocation(d_ptr->m_shaderSprites, "colorKey"), colorKey);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, d_ptr->m_spriteInstanceList.size());
+
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+}
+
 } // namespace ofnx::graphics
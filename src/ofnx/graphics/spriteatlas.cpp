@@ -0,0 +1,305 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "ofnx/graphics/spriteatlas.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+#include "ofnx/files/arnvit.h"
+#include "ofnx/tools/log.h"
+
+namespace ofnx::graphics {
+
+/* PRIVATE */
+class SpriteAtlas::Impl {
+    friend class SpriteAtlas;
+
+public:
+    struct SkylineNode {
+        int x;
+        int y;
+        int width;
+    };
+
+    struct Page {
+        std::vector<SkylineNode> skyline;
+        std::vector<uint16_t> pixels;
+    };
+
+public:
+    bool findPosition(const Page& page, int width, int height, int& bestX, int& bestY, int& bestNode) const;
+    void insertNode(Page& page, int node, int x, int y, int width, int height);
+    bool place(int width, int height, Region& region);
+    void blit(const Region& region, const uint8_t* dataRgb565);
+
+private:
+    int m_pageSize;
+    std::vector<Page> m_pageList;
+    std::vector<Region> m_regionList;
+    std::unordered_map<std::string, int> m_nameMap;
+};
+
+bool SpriteAtlas::Impl::findPosition(const Page& page, int width, int height, int& bestX, int& bestY, int& bestNode) const
+{
+    // Bottom-left rule: lowest top edge first, then narrowest skyline segment
+    int bestTop = INT_MAX;
+    int bestWidth = INT_MAX;
+    bestNode = -1;
+
+    for (size_t i = 0; i < page.skyline.size(); ++i) {
+        int x = page.skyline[i].x;
+        if (x + width > m_pageSize) {
+            break;
+        }
+
+        int y = 0;
+        int remaining = width;
+        for (size_t j = i; remaining > 0; ++j) {
+            y = std::max(y, page.skyline[j].y);
+            remaining -= page.skyline[j].width;
+        }
+
+        int top = y + height;
+        if (top > m_pageSize) {
+            continue;
+        }
+
+        if (top < bestTop || (top == bestTop && page.skyline[i].width < bestWidth)) {
+            bestTop = top;
+            bestWidth = page.skyline[i].width;
+            bestNode = i;
+            bestX = x;
+            bestY = y;
+        }
+    }
+
+    return bestNode >= 0;
+}
+
+void SpriteAtlas::Impl::insertNode(Page& page, int node, int x, int y, int width, int height)
+{
+    page.skyline.insert(page.skyline.begin() + node, { x, y + height, width });
+
+    // Shrink or remove segments now covered by the new one
+    for (size_t i = node + 1; i < page.skyline.size();) {
+        SkylineNode& previous = page.skyline[i - 1];
+        SkylineNode& current = page.skyline[i];
+        int overlap = previous.x + previous.width - current.x;
+        if (overlap <= 0) {
+            break;
+        }
+
+        if (overlap < current.width) {
+            current.x += overlap;
+            current.width -= overlap;
+            break;
+        }
+
+        page.skyline.erase(page.skyline.begin() + i);
+    }
+
+    // Merge neighbours at the same height
+    for (size_t i = 0; i + 1 < page.skyline.size();) {
+        if (page.skyline[i].y == page.skyline[i + 1].y) {
+            page.skyline[i].width += page.skyline[i + 1].width;
+            page.skyline.erase(page.skyline.begin() + i + 1);
+        } else {
+            ++i;
+        }
+    }
+}
+
+bool SpriteAtlas::Impl::place(int width, int height, Region& region)
+{
+    if (width <= 0 || height <= 0 || width > m_pageSize || height > m_pageSize) {
+        LOG_ERROR("Sprite does not fit in atlas page: {}x{}", width, height);
+        return false;
+    }
+
+    int x, y, node;
+    int page = 0;
+    for (; page < m_pageList.size(); ++page) {
+        if (findPosition(m_pageList[page], width, height, x, y, node)) {
+            break;
+        }
+    }
+
+    if (page == m_pageList.size()) {
+        Page newPage;
+        newPage.skyline.push_back({ 0, 0, m_pageSize });
+        newPage.pixels.resize(m_pageSize * m_pageSize, 0);
+        m_pageList.push_back(std::move(newPage));
+
+        findPosition(m_pageList[page], width, height, x, y, node);
+    }
+
+    insertNode(m_pageList[page], node, x, y, width, height);
+
+    region.page = page;
+    region.x = x;
+    region.y = y;
+    region.width = width;
+    region.height = height;
+
+    return true;
+}
+
+void SpriteAtlas::Impl::blit(const Region& region, const uint8_t* dataRgb565)
+{
+    uint16_t* pixels = m_pageList[region.page].pixels.data();
+    for (int y = 0; y < region.height; ++y) {
+        uint16_t* rowOut = pixels + (region.y + y) * m_pageSize + region.x;
+        std::memcpy(rowOut, dataRgb565 + y * region.width * 2, region.width * 2);
+    }
+}
+
+/* PUBLIC */
+SpriteAtlas::SpriteAtlas(int pageSize)
+{
+    d_ptr = new Impl;
+    d_ptr->m_pageSize = pageSize;
+}
+
+SpriteAtlas::~SpriteAtlas()
+{
+    delete d_ptr;
+}
+
+bool SpriteAtlas::build(const ofnx::files::ArnVit& arnVit)
+{
+    clear();
+
+    if (!arnVit.isOpen()) {
+        LOG_ERROR("ArnVit is not open");
+        return false;
+    }
+
+    std::vector<ofnx::files::ArnVit::ArnVitFile> fileList(arnVit.fileCount());
+    for (int i = 0; i < fileList.size(); ++i) {
+        fileList[i] = arnVit.getFile(i);
+        if (fileList[i].data.size() < fileList[i].width * fileList[i].height * 2) {
+            LOG_ERROR("Invalid sprite data: {}", fileList[i].fileName);
+            clear();
+            return false;
+        }
+    }
+
+    // Tallest first keeps the skyline flat
+    std::vector<int> order(fileList.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        if (fileList[a].height != fileList[b].height) {
+            return fileList[a].height > fileList[b].height;
+        }
+        return fileList[a].width > fileList[b].width;
+    });
+
+    d_ptr->m_regionList.resize(fileList.size());
+    for (int index : order) {
+        const ofnx::files::ArnVit::ArnVitFile& file = fileList[index];
+        Region& region = d_ptr->m_regionList[index];
+        if (!d_ptr->place(file.width, file.height, region)) {
+            clear();
+            return false;
+        }
+
+        d_ptr->blit(region, file.data.data());
+        d_ptr->m_nameMap[file.fileName] = index;
+    }
+
+    return true;
+}
+
+int SpriteAtlas::addSprite(const std::string& name, int width, int height, const uint16_t* dataRgb565)
+{
+    Region region;
+    if (!d_ptr->place(width, height, region)) {
+        return -1;
+    }
+
+    d_ptr->blit(region, reinterpret_cast<const uint8_t*>(dataRgb565));
+
+    int spriteId = d_ptr->m_regionList.size();
+    d_ptr->m_regionList.push_back(region);
+    d_ptr->m_nameMap[name] = spriteId;
+
+    return spriteId;
+}
+
+void SpriteAtlas::clear()
+{
+    d_ptr->m_pageList.clear();
+    d_ptr->m_regionList.clear();
+    d_ptr->m_nameMap.clear();
+}
+
+int SpriteAtlas::pageSize() const
+{
+    return d_ptr->m_pageSize;
+}
+
+int SpriteAtlas::pageCount() const
+{
+    return d_ptr->m_pageList.size();
+}
+
+int SpriteAtlas::spriteCount() const
+{
+    return d_ptr->m_regionList.size();
+}
+
+int SpriteAtlas::indexOf(std::string_view name) const
+{
+    auto it = d_ptr->m_nameMap.find(std::string(name));
+    if (it == d_ptr->m_nameMap.end()) {
+        return -1;
+    }
+
+    return it->second;
+}
+
+SpriteAtlas::Region SpriteAtlas::region(int spriteId) const
+{
+    if (spriteId < 0 || spriteId >= d_ptr->m_regionList.size()) {
+        return {};
+    }
+
+    return d_ptr->m_regionList[spriteId];
+}
+
+const uint16_t* SpriteAtlas::pageData(int page) const
+{
+    if (page < 0 || page >= d_ptr->m_pageList.size()) {
+        return nullptr;
+    }
+
+    return d_ptr->m_pageList[page].pixels.data();
+}
+
+} // namespace ofnx::graphics
@@ -0,0 +1,345 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "ofnx/tools/randomaccessfile.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "ofnx/tools/log.h"
+
+namespace ofnx::tools {
+
+/* PRIVATE */
+class RandomAccessFile::Impl {
+    friend class RandomAccessFile;
+
+public:
+    bool readSome(uint64_t offset, size_t size, uint8_t* data, size_t& readSize) const;
+    void unmap();
+
+private:
+#ifdef _WIN32
+    HANDLE m_handle = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+    uint64_t m_size = 0;
+
+    const uint8_t* m_mappedData = nullptr;
+};
+
+bool RandomAccessFile::Impl::readSome(uint64_t offset, size_t size, uint8_t* data, size_t& readSize) const
+{
+#ifdef _WIN32
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = DWORD(offset & 0xFFFFFFFF);
+    overlapped.OffsetHigh = DWORD(offset >> 32);
+
+    DWORD chunkSize = DWORD(std::min<size_t>(size, 0x40000000));
+    DWORD chunkRead = 0;
+    if (!ReadFile(m_handle, data, chunkSize, &chunkRead, &overlapped)) {
+        return false;
+    }
+
+    readSize = chunkRead;
+    return true;
+#else
+    ssize_t chunkRead;
+    do {
+        chunkRead = pread(m_fd, data, size, off_t(offset));
+    } while (chunkRead < 0 && errno == EINTR);
+
+    if (chunkRead < 0) {
+        return false;
+    }
+
+    readSize = chunkRead;
+    return true;
+#endif
+}
+
+void RandomAccessFile::Impl::unmap()
+{
+    if (!m_mappedData) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_mappedData);
+    CloseHandle(m_mapping);
+    m_mapping = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(m_mappedData), m_size);
+#endif
+
+    m_mappedData = nullptr;
+}
+
+/* PUBLIC */
+RandomAccessFile::RandomAccessFile()
+{
+    d_ptr = new Impl;
+}
+
+RandomAccessFile::~RandomAccessFile()
+{
+    close();
+    delete d_ptr;
+}
+
+bool RandomAccessFile::open(const std::string& fileName)
+{
+    close();
+
+#ifdef _WIN32
+    d_ptr->m_handle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (d_ptr->m_handle == INVALID_HANDLE_VALUE) {
+        LOG_ERROR("Could not open file: {}", fileName);
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(d_ptr->m_handle, &size)) {
+        LOG_ERROR("Could not get file size: {}", fileName);
+        close();
+        return false;
+    }
+    d_ptr->m_size = size.QuadPart;
+#else
+    d_ptr->m_fd = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+    if (d_ptr->m_fd < 0) {
+        LOG_ERROR("Could not open file: {}", fileName);
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(d_ptr->m_fd, &fileStat) != 0) {
+        LOG_ERROR("Could not get file size: {}", fileName);
+        close();
+        return false;
+    }
+    d_ptr->m_size = fileStat.st_size;
+#endif
+
+    return true;
+}
+
+void RandomAccessFile::close()
+{
+    d_ptr->unmap();
+
+#ifdef _WIN32
+    if (d_ptr->m_handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(d_ptr->m_handle);
+        d_ptr->m_handle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (d_ptr->m_fd >= 0) {
+        ::close(d_ptr->m_fd);
+        d_ptr->m_fd = -1;
+    }
+#endif
+
+    d_ptr->m_size = 0;
+}
+
+bool RandomAccessFile::isOpen() const
+{
+#ifdef _WIN32
+    return d_ptr->m_handle != INVALID_HANDLE_VALUE;
+#else
+    return d_ptr->m_fd >= 0;
+#endif
+}
+
+uint64_t RandomAccessFile::size() const
+{
+    return d_ptr->m_size;
+}
+
+bool RandomAccessFile::read(uint64_t offset, size_t size, uint8_t* data) const
+{
+    if (!isOpen()) {
+        LOG_ERROR("File not open");
+        return false;
+    }
+
+    if (offset > d_ptr->m_size || size > d_ptr->m_size - offset) {
+        LOG_ERROR("Out of range");
+        return false;
+    }
+
+    if (d_ptr->m_mappedData) {
+        std::memcpy(data, d_ptr->m_mappedData + offset, size);
+        return true;
+    }
+
+    // Positional reads may return less than requested, loop until done
+    while (size > 0) {
+        size_t readSize = 0;
+        if (!d_ptr->readSome(offset, size, data, readSize) || readSize == 0) {
+            LOG_ERROR("Read error");
+            return false;
+        }
+
+        offset += readSize;
+        data += readSize;
+        size -= readSize;
+    }
+
+    return true;
+}
+
+bool RandomAccessFile::map()
+{
+    if (!isOpen()) {
+        LOG_ERROR("File not open");
+        return false;
+    }
+
+    if (d_ptr->m_mappedData) {
+        return true;
+    }
+
+    if (d_ptr->m_size == 0) {
+        LOG_ERROR("Cannot map an empty file");
+        return false;
+    }
+
+#ifdef _WIN32
+    d_ptr->m_mapping = CreateFileMappingA(d_ptr->m_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!d_ptr->m_mapping) {
+        LOG_ERROR("Could not map file");
+        return false;
+    }
+
+    void* data = MapViewOfFile(d_ptr->m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        LOG_ERROR("Could not map file");
+        CloseHandle(d_ptr->m_mapping);
+        d_ptr->m_mapping = nullptr;
+        return false;
+    }
+#else
+    void* data = mmap(nullptr, d_ptr->m_size, PROT_READ, MAP_PRIVATE, d_ptr->m_fd, 0);
+    if (data == MAP_FAILED) {
+        LOG_ERROR("Could not map file");
+        return false;
+    }
+#endif
+
+    d_ptr->m_mappedData = static_cast<const uint8_t*>(data);
+
+    return true;
+}
+
+bool RandomAccessFile::isMapped() const
+{
+    return d_ptr->m_mappedData != nullptr;
+}
+
+std::span<const uint8_t> RandomAccessFile::mappedData() const
+{
+    if (!d_ptr->m_mappedData) {
+        return {};
+    }
+
+    return std::span<const uint8_t>(d_ptr->m_mappedData, d_ptr->m_size);
+}
+
+void RandomAccessFile::advise(uint64_t offset, uint64_t size, Advice advice) const
+{
+    if (!isOpen() || offset >= d_ptr->m_size) {
+        return;
+    }
+
+    if (size == 0 || size > d_ptr->m_size - offset) {
+        size = d_ptr->m_size - offset;
+    }
+
+#ifdef _WIN32
+    if (d_ptr->m_mappedData && advice == Advice::WILL_NEED) {
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = const_cast<uint8_t*>(d_ptr->m_mappedData + offset);
+        range.NumberOfBytes = SIZE_T(size);
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#else
+    if (d_ptr->m_mappedData) {
+        // madvise needs a page aligned start
+        uint64_t pageSize = uint64_t(sysconf(_SC_PAGESIZE));
+        uint64_t start = offset & ~(pageSize - 1);
+        int flag = MADV_NORMAL;
+        switch (advice) {
+        case Advice::SEQUENTIAL:
+            flag = MADV_SEQUENTIAL;
+            break;
+        case Advice::RANDOM:
+            flag = MADV_RANDOM;
+            break;
+        case Advice::WILL_NEED:
+            flag = MADV_WILLNEED;
+            break;
+        default:
+            break;
+        }
+        madvise(const_cast<uint8_t*>(d_ptr->m_mappedData + start), size + (offset - start), flag);
+    } else {
+#ifdef POSIX_FADV_NORMAL
+        int flag = POSIX_FADV_NORMAL;
+        switch (advice) {
+        case Advice::SEQUENTIAL:
+            flag = POSIX_FADV_SEQUENTIAL;
+            break;
+        case Advice::RANDOM:
+            flag = POSIX_FADV_RANDOM;
+            break;
+        case Advice::WILL_NEED:
+            flag = POSIX_FADV_WILLNEED;
+            break;
+        default:
+            break;
+        }
+        posix_fadvise(d_ptr->m_fd, off_t(offset), off_t(size), flag);
+#endif
+    }
+#endif
+}
+
+} // namespace ofnx::tools
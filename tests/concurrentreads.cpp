@@ -0,0 +1,164 @@
+/*
+MIT License
+
+Copyright (c) 2026 Alys_Elica
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+ * Reads ArnVit sprites and Pak entries from several threads at once and checks them against the written data
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ofnx/files/arnvit.h"
+#include "ofnx/files/pak.h"
+
+#define TEST_THREADS 8
+#define TEST_ROUNDS 500
+#define TEST_ENTRIES 40
+
+/* Helper functions */
+std::vector<uint8_t> makeData(int index, size_t size)
+{
+    std::vector<uint8_t> data(size);
+    uint32_t value = 0x9E3779B9u * (index + 1);
+    for (uint8_t& byte : data) {
+        value = value * 1664525u + 1013904223u;
+        byte = uint8_t(value >> 24);
+    }
+
+    return data;
+}
+
+void writeLe32(std::ofstream& file, uint32_t value)
+{
+    uint8_t bytes[4] = { uint8_t(value), uint8_t(value >> 8), uint8_t(value >> 16), uint8_t(value >> 24) };
+    file.write(reinterpret_cast<const char*>(bytes), 4);
+}
+
+template <typename Read>
+int readConcurrently(const std::vector<std::vector<uint8_t>>& expected, Read&& read)
+{
+    std::atomic_int errors = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < TEST_THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            for (int round = 0; round < TEST_ROUNDS; ++round) {
+                int index = (round * 7 + t * 13) % int(expected.size());
+                if (read(index) != expected[index]) {
+                    ++errors;
+                }
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    return errors;
+}
+
+bool testArnVit(ofnx::files::ArnVit::AccessMode mode)
+{
+    std::vector<std::vector<uint8_t>> sprites;
+    {
+        std::ofstream vit("concurrentreads.vit", std::ios::binary);
+        std::ofstream arn("concurrentreads.arn", std::ios::binary);
+        writeLe32(vit, TEST_ENTRIES);
+        writeLe32(vit, 0);
+        for (int i = 0; i < TEST_ENTRIES; ++i) {
+            uint32_t width = 8 + i % 13;
+            uint32_t height = 4 + i % 7;
+            sprites.push_back(makeData(i, width * height * 2));
+
+            char name[32] = { 0 };
+            std::snprintf(name, sizeof(name), "sprite%02d.bmp", i);
+            vit.write(name, sizeof(name));
+            for (uint32_t value : { 1u, 2u, width, height, 3u, uint32_t(sprites.back().size()), 4u }) {
+                writeLe32(vit, value);
+            }
+            arn.write(reinterpret_cast<const char*>(sprites.back().data()), sprites.back().size());
+        }
+    }
+
+    ofnx::files::ArnVit arnVit;
+    if (!arnVit.open("concurrentreads.vit", "concurrentreads.arn", mode)) {
+        std::fprintf(stderr, "ArnVit::open failed\n");
+        return false;
+    }
+
+    int errors = readConcurrently(sprites, [&](int index) { return arnVit.getFile(index).data; });
+    if (errors != 0) {
+        std::fprintf(stderr, "ArnVit::getFile: %d mismatches\n", errors);
+        return false;
+    }
+
+    return true;
+}
+
+bool testPak()
+{
+    std::vector<std::vector<uint8_t>> entries;
+    {
+        ofnx::files::Pak pak;
+        for (int i = 0; i < TEST_ENTRIES; ++i) {
+            // Half random, half repetitive to go through both compression paths
+            std::vector<uint8_t> data = i % 2 ? makeData(i, 3000 + i * 100) : std::vector<uint8_t>(3000 + i * 100, uint8_t(i));
+            pak.addFile("entry" + std::to_string(i), data);
+            entries.push_back(std::move(data));
+        }
+
+        if (!pak.save("concurrentreads.pak")) {
+            std::fprintf(stderr, "Pak::save failed\n");
+            return false;
+        }
+    }
+
+    ofnx::files::Pak pak;
+    if (!pak.open("concurrentreads.pak")) {
+        std::fprintf(stderr, "Pak::open failed\n");
+        return false;
+    }
+
+    int errors = readConcurrently(entries, [&](int index) { return pak.fileData(index); });
+    if (errors != 0) {
+        std::fprintf(stderr, "Pak::fileData: %d mismatches\n", errors);
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    bool success = testArnVit(ofnx::files::ArnVit::AccessMode::READ);
+    success &= testArnVit(ofnx::files::ArnVit::AccessMode::MAP);
+    success &= testPak();
+
+    return success ? 0 : 1;
+}